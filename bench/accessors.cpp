@@ -0,0 +1,93 @@
+#include "bench.hpp"
+#include "wide.hpp"
+#include <kser/kser.hpp>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace {
+	template<typename T>
+	void bench_accessors(bench::Runner& bench, std::string_view size) {
+		auto s = bench::make_wide<T>();
+		auto names = bench::wide_names(s);
+		std::size_t next = 0;
+		// cycles through every name, so no one field is favoured
+		auto next_name = [&] {
+			auto name = names[next];
+			next = next + 1 == names.size() ? 0 : next + 1;
+			return name;
+		};
+		auto label = [&](std::string_view what) {
+			return std::string(what) + " (" + std::string(size) + " fields)";
+		};
+
+		bench.run(label("get_value"), [&] {
+			auto value = kser::get_value<int>(s, next_name());
+			bench::do_not_optimize(value);
+		});
+		bench.run(label("get_value, hand-written"), [&] {
+			int value = 0;
+			bench::hand_get(s, next_name(), value);
+			bench::do_not_optimize(value);
+		});
+
+		bench.run(label("set_value"), [&] {
+			kser::set_value(s, next_name(), 1);
+			bench::do_not_optimize(s);
+		});
+		bench.run(label("set_value, hand-written"), [&] {
+			bench::hand_set(s, next_name(), 1);
+			bench::do_not_optimize(s);
+		});
+
+		std::map<std::string_view, int> in;
+		for (auto name : names) {
+			in[name] = 2;
+		}
+		bench.run(label("set_values"), [&] {
+			kser::set_values(s, in);
+			bench::do_not_optimize(s);
+		});
+		bench.run(label("set_values, hand-written"), [&] {
+			for (const auto& [name, value] : in) {
+				bench::hand_set(s, name, value);
+			}
+			bench::do_not_optimize(s);
+		});
+
+		bench.run(label("get_value_map"), [&] {
+			auto out = kser::get_value_map<std::map<std::string_view, int>>(s);
+			bench::do_not_optimize(out);
+		});
+		bench.run(label("get_value_map, hand-written"), [&] {
+			std::map<std::string_view, int> out;
+			bench::hand_value_map(s, out);
+			bench::do_not_optimize(out);
+		});
+
+		bench.run(label("visit_fields"), [&] {
+			int sum = 0;
+			auto visitor = [&](const auto& field) {
+				sum += field.value;
+			};
+			kser::visit_fields(s, visitor);
+			bench::do_not_optimize(sum);
+		});
+		bench.run(label("visit_fields, hand-written"), [&] {
+			auto sum = bench::hand_sum(s);
+			bench::do_not_optimize(sum);
+		});
+	}
+}
+
+BENCHMARK("accessors/4", bench_accessors_4) {
+	bench_accessors<bench::Wide4>(bench, "4");
+}
+
+BENCHMARK("accessors/32", bench_accessors_32) {
+	bench_accessors<bench::Wide32>(bench, "32");
+}
+
+BENCHMARK("accessors/256", bench_accessors_256) {
+	bench_accessors<bench::Wide256>(bench, "256");
+}
\ No newline at end of file
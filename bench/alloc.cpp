@@ -0,0 +1,22 @@
+#include "bench.hpp"
+#include <cstdlib>
+#include <new>
+
+// Counts allocations for Runner. The array forms forward to these by
+// default; aligned allocations aren't counted.
+
+void* operator new(std::size_t size) {
+	bench::allocations.fetch_add(1, std::memory_order_relaxed);
+	if (auto p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
\ No newline at end of file
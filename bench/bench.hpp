@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+	// keeps the optimizer from discarding a result
+	template<typename T>
+	inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	// incremented by the operator new in alloc.cpp
+	inline std::atomic<std::size_t> allocations{0};
+
+	struct Runner {
+		std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+
+		// calls fn in a loop until it has run for at least min_time,
+		// then prints the average time and allocations per call
+		void run(std::string_view label, auto&& fn) {
+			using clock = std::chrono::steady_clock;
+			std::size_t iterations = 1;
+			while (true) {
+				auto start_allocations = allocations.load(std::memory_order_relaxed);
+				auto start = clock::now();
+				for (std::size_t i = 0; i < iterations; ++i) {
+					fn();
+				}
+				auto elapsed = clock::now() - start;
+				if (elapsed >= min_time) {
+					auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+					auto allocs = static_cast<double>(
+						allocations.load(std::memory_order_relaxed) - start_allocations
+					) / iterations;
+					std::printf(
+						"  %-56.*s %12.1f ns/op %10.2f allocs/op\n",
+						static_cast<int>(label.size()), label.data(),
+						ns,
+						allocs
+					);
+					return;
+				}
+				iterations *= 2;
+			}
+		}
+	};
+
+	using BenchmarkFn = void (*)(Runner&);
+
+	struct Benchmark {
+		std::string_view name;
+		BenchmarkFn fn;
+	};
+
+	inline std::vector<Benchmark>& benchmarks() {
+		static std::vector<Benchmark> out;
+		return out;
+	}
+
+	inline bool register_benchmark(std::string_view name, BenchmarkFn fn) {
+		benchmarks().push_back({name, fn});
+		return true;
+	}
+}
+
+#define BENCHMARK(name, id) \
+	static void id(bench::Runner& bench); \
+	static const bool id##_registered = bench::register_benchmark(name, id); \
+	static void id(bench::Runner& bench)
@@ -0,0 +1,19 @@
+#include "bench.hpp"
+
+// usage: KSerBench [filter]
+// runs every benchmark whose name contains filter
+int main(int argc, char** argv) {
+	std::string_view filter = argc > 1 ? argv[1] : "";
+	bench::Runner runner;
+	for (const auto& benchmark : bench::benchmarks()) {
+		if (benchmark.name.find(filter) == std::string_view::npos) {
+			continue;
+		}
+		std::printf(
+			"%.*s\n",
+			static_cast<int>(benchmark.name.size()), benchmark.name.data()
+		);
+		benchmark.fn(runner);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "bench.hpp"
+#include <kser/kser.hpp>
+#include <kser/parse.hpp>
+#include <kser/serialize.hpp>
+#include <charconv>
+#include <map>
+#include <string>
+#include <variant>
+
+namespace {
+	struct Record {
+		kser::NamedField<int, "id"> id;
+		kser::NamedField<float, "x"> x;
+		kser::NamedField<float, "y"> y;
+		kser::NamedField<float, "z"> z;
+		kser::NamedField<std::string, "name"> name;
+		kser::NamedField<bool, "active"> active;
+		kser::NamedField<int, "score"> score;
+		kser::NamedField<double, "ratio"> ratio;
+	};
+
+	using value_t = std::variant<std::monostate, bool, double, std::string>;
+	using map_t = std::map<std::string_view, value_t>;
+
+	template<typename T>
+	struct VariantCaster {
+		T operator ()(const value_t& v) {
+			return std::visit([](const auto& x) -> T {
+				if constexpr (std::convertible_to<decltype(x), T>) {
+					return static_cast<T>(x);
+				}
+				else {
+					return T{};
+				}
+			}, v);
+		}
+	};
+
+	// the route parse_json replaces: a flat object parsed into a map,
+	// then copied into the struct with set_values
+	map_t parse_flat_object(std::string_view json) {
+		map_t out;
+		std::size_t i = 0;
+		auto skip_space = [&] {
+			while (i < json.size() && (json[i] == ' ' || json[i] == '\n')) {
+				++i;
+			}
+		};
+		auto parse_string = [&] {
+			auto start = ++i;
+			while (json[i] != '"') {
+				++i;
+			}
+			return json.substr(start, i++ - start);
+		};
+
+		skip_space();
+		++i; // {
+		while (true) {
+			skip_space();
+			auto key = parse_string();
+			skip_space();
+			++i; // :
+			skip_space();
+			if (json[i] == '"') {
+				out[key] = std::string(parse_string());
+			}
+			else if (json.substr(i, 4) == "true") {
+				out[key] = true;
+				i += 4;
+			}
+			else if (json.substr(i, 5) == "false") {
+				out[key] = false;
+				i += 5;
+			}
+			else {
+				double d;
+				auto result = std::from_chars(json.data() + i, json.data() + json.size(), d);
+				out[key] = d;
+				i = result.ptr - json.data();
+			}
+			skip_space();
+			if (json[i++] == '}') {
+				return out;
+			}
+		}
+	}
+}
+
+BENCHMARK("parse_json", bench_parse_json) {
+	Record record {
+		42,
+		1.5f,
+		-2.25f,
+		100.0f,
+		"a record with a reasonably long name",
+		true,
+		9001,
+		0.125,
+	};
+	auto json = kser::serialize_json(record);
+
+	bench.run("map + set_values", [&] {
+		Record out{};
+		auto map = parse_flat_object(json);
+		kser::set_values<VariantCaster>(out, map);
+		bench::do_not_optimize(out);
+	});
+
+	bench.run("parse_json<T>", [&] {
+		auto out = kser::parse_json<Record>(json);
+		bench::do_not_optimize(out);
+	});
+
+	Record reused{};
+	bench.run("parse_json into existing", [&] {
+		kser::parse_json(json, reused);
+		bench::do_not_optimize(reused);
+	});
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "bench.hpp"
+#include "wide.hpp"
+#include <kser/batch.hpp>
+#include <kser/serialize.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	template<typename T>
+	void bench_serialize_json(bench::Runner& bench, std::string_view size) {
+		auto s = bench::make_wide<T>();
+		auto label = [&](std::string_view what) {
+			return std::string(what) + " (" + std::string(size) + " fields)";
+		};
+
+		bench.run(label("serialize_json"), [&] {
+			auto out = kser::serialize_json(s);
+			bench::do_not_optimize(out);
+		});
+
+		std::string out;
+		bench.run(label("serialize_json into reused string"), [&] {
+			out.clear();
+			kser::serialize_json(s, out);
+			bench::do_not_optimize(out);
+		});
+		bench.run(label("hand-written into reused string"), [&] {
+			out.clear();
+			bench::hand_serialize_json(s, out);
+			bench::do_not_optimize(out);
+		});
+	}
+}
+
+BENCHMARK("serialize_json/4", bench_serialize_json_4) {
+	bench_serialize_json<bench::Wide4>(bench, "4");
+}
+
+BENCHMARK("serialize_json/32", bench_serialize_json_32) {
+	bench_serialize_json<bench::Wide32>(bench, "32");
+}
+
+BENCHMARK("serialize_json/256", bench_serialize_json_256) {
+	bench_serialize_json<bench::Wide256>(bench, "256");
+}
+
+BENCHMARK("serialize_json/batch", bench_serialize_json_batch) {
+	std::vector<bench::Wide32> records(100000, bench::make_wide<bench::Wide32>());
+	std::string out;
+	bench.run("one at a time (100000 records, 32 fields)", [&] {
+		out.clear();
+		out.push_back('[');
+		for (const auto& record : records) {
+			if (out.size() > 1) {
+				out.append(", ");
+			}
+			kser::serialize_json(record, out);
+		}
+		out.push_back(']');
+		bench::do_not_optimize(out);
+	});
+	bench.run("serialize_json_batch (100000 records, 32 fields)", [&] {
+		out.clear();
+		kser::serialize_json_batch(records, out);
+		bench::do_not_optimize(out);
+	});
+}
\ No newline at end of file
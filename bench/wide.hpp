@@ -0,0 +1,83 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <charconv> 	// to_chars
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Structs of int fields named f0, f1, ..., with hand-written versions of
+// what kser does for them, generated from the same field lists.
+
+// the names aren't consecutive numbers, only unique
+#define BENCH_FIELDS_8(X, p) X(p##0) X(p##1) X(p##2) X(p##3) X(p##4) X(p##5) X(p##6) X(p##7)
+#define BENCH_FIELDS_64(X, p) \
+	BENCH_FIELDS_8(X, p##0) BENCH_FIELDS_8(X, p##1) BENCH_FIELDS_8(X, p##2) BENCH_FIELDS_8(X, p##3) \
+	BENCH_FIELDS_8(X, p##4) BENCH_FIELDS_8(X, p##5) BENCH_FIELDS_8(X, p##6) BENCH_FIELDS_8(X, p##7)
+
+#define BENCH_FIELDS_4(X) X(0) X(1) X(2) X(3)
+#define BENCH_FIELDS_32(X) BENCH_FIELDS_8(X, 1) BENCH_FIELDS_8(X, 2) BENCH_FIELDS_8(X, 3) BENCH_FIELDS_8(X, 4)
+#define BENCH_FIELDS_256(X) BENCH_FIELDS_64(X, 1) BENCH_FIELDS_64(X, 2) BENCH_FIELDS_64(X, 3) BENCH_FIELDS_64(X, 4)
+
+#define BENCH_FIELD(n) kser::NamedField<int, "f" #n> f##n;
+#define BENCH_NAME(n) "f" #n,
+#define BENCH_HAND_GET(n) if (name == "f" #n) { out = s.f##n.value; return true; }
+#define BENCH_HAND_SET(n) if (name == "f" #n) { s.f##n.value = value; return true; }
+#define BENCH_HAND_SUM(n) + s.f##n.value
+#define BENCH_HAND_MAP(n) out["f" #n] = s.f##n.value;
+#define BENCH_HAND_JSON(n) \
+	out.append(first ? "{\"f" #n "\": " : ", \"f" #n "\": "); \
+	first = false; \
+	bench::append_int(out, s.f##n.value);
+
+#define BENCH_WIDE_STRUCT(Name, FIELDS) \
+	struct Name { \
+		FIELDS(BENCH_FIELD) \
+	}; \
+	inline constexpr std::string_view Name##_names[] = { FIELDS(BENCH_NAME) }; \
+	inline std::span<const std::string_view> wide_names(const Name&) { \
+		return Name##_names; \
+	} \
+	inline bool hand_get(const Name& s, std::string_view name, int& out) { \
+		FIELDS(BENCH_HAND_GET) \
+		return false; \
+	} \
+	inline bool hand_set(Name& s, std::string_view name, int value) { \
+		FIELDS(BENCH_HAND_SET) \
+		return false; \
+	} \
+	inline int hand_sum(const Name& s) { \
+		return 0 FIELDS(BENCH_HAND_SUM); \
+	} \
+	inline void hand_value_map(const Name& s, std::map<std::string_view, int>& out) { \
+		FIELDS(BENCH_HAND_MAP) \
+	} \
+	inline void hand_serialize_json(const Name& s, std::string& out) { \
+		bool first = true; \
+		FIELDS(BENCH_HAND_JSON) \
+		out.append(first ? "{}" : "}"); \
+	}
+
+namespace bench {
+	inline void append_int(std::string& out, int value) {
+		char buf[16];
+		out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+	}
+
+	BENCH_WIDE_STRUCT(Wide4, BENCH_FIELDS_4)
+	BENCH_WIDE_STRUCT(Wide32, BENCH_FIELDS_32)
+	BENCH_WIDE_STRUCT(Wide256, BENCH_FIELDS_256)
+
+	// a struct with field i set to i
+	template<typename T>
+	T make_wide() {
+		T s{};
+		int i = 0;
+		auto visitor = [&](auto& field) {
+			field.value = i++;
+		};
+		kser::visit_fields(s, visitor);
+		return s;
+	}
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <kser/kser.hpp>
 #include <kser/serialize.hpp>
+#include <kser/parse.hpp>
 #include <iostream>
 #include <map>
 
@@ -35,5 +36,21 @@ int main(){
 	std::cout << kser::serialize_json(player) << std::endl;
 	// {"max_health": 120, "damage": 10.00}
 
+	// serializing into an existing buffer reuses its capacity
+	std::string buffer;
+	for (int i = 0; i < 3; ++i) {
+		buffer.clear();
+		player.max_health.value = i;
+		kser::serialize_json(player, buffer);
+		std::cout << buffer << std::endl;
+	}
+	// {"max_health": 0, "damage": 10.00}
+	// {"max_health": 1, "damage": 10.00}
+	// {"max_health": 2, "damage": 10.00}
+
+	auto parsed = kser::parse_json<Player>(R"({"max_health": 80, "damage": 2.5})");
+	std::cout << "Parsed max health: " << parsed.max_health.value << std::endl;
+	// Parsed max health: 80
+
 	return 0;
 }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <kser/serialize.hpp>
+#include <algorithm> 	// min
+#include <exception>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kser {
+	enum class JsonBatchFormat {
+		// [a, b, c]
+		Array,
+		// one value per line, each followed by \n
+		Lines,
+	};
+
+	namespace detail {
+		template<size_t TPrecision>
+		void write_json_batch_chunk(
+			auto& sink,
+			const auto& values,
+			std::size_t first,
+			std::size_t last,
+			JsonBatchFormat format
+		) {
+			auto it = std::ranges::begin(values);
+			for (auto i = first; i < last; ++i) {
+				if (format == JsonBatchFormat::Array && i != 0) {
+					sink.write(", ");
+				}
+				write_json<TPrecision>(sink, it[i]);
+				if (format == JsonBatchFormat::Lines) {
+					sink.put('\n');
+				}
+			}
+		}
+	}
+
+	// Appends every element of values as JSON to out, splitting the range into
+	// one contiguous chunk per thread. Each thread writes its chunk to its own
+	// buffer, and the buffers are appended to out in order once all are done, so
+	// the output is the same as serializing the elements one after another.
+	// threads = 0 uses one thread per core; with one thread, nothing is copied.
+	template<size_t TPrecision = 2, std::ranges::random_access_range TRange>
+		requires std::ranges::sized_range<TRange>
+			&& JsonSerializable<std::ranges::range_value_t<TRange>>
+	void serialize_json_batch(
+		const TRange& values,
+		std::string& out,
+		JsonBatchFormat format = JsonBatchFormat::Array,
+		std::size_t threads = 0
+	) {
+		auto n = static_cast<std::size_t>(std::ranges::size(values));
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threads = std::max<std::size_t>(1, std::min(threads, n));
+
+		if (format == JsonBatchFormat::Array) {
+			out.push_back('[');
+		}
+		if (threads == 1) {
+			detail::JsonStringSink sink{out};
+			detail::write_json_batch_chunk<TPrecision>(sink, values, 0, n, format);
+		}
+		else {
+			std::vector<std::string> chunks(threads);
+			std::vector<std::exception_ptr> errors(threads);
+			{
+				std::vector<std::jthread> workers;
+				workers.reserve(threads - 1);
+				auto work = [&](std::size_t t) {
+					try {
+						detail::JsonStringSink sink{chunks[t]};
+						detail::write_json_batch_chunk<TPrecision>(
+							sink,
+							values,
+							n * t / threads,
+							n * (t + 1) / threads,
+							format
+						);
+					} catch (...) {
+						errors[t] = std::current_exception();
+					}
+				};
+				for (std::size_t t = 1; t < threads; ++t) {
+					workers.emplace_back(work, t);
+				}
+				work(0);
+			}
+			for (auto& error : errors) {
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+
+			std::size_t size = out.size();
+			for (const auto& chunk : chunks) {
+				size += chunk.size();
+			}
+			out.reserve(size + 1);
+			for (const auto& chunk : chunks) {
+				out.append(chunk);
+			}
+		}
+		if (format == JsonBatchFormat::Array) {
+			out.push_back(']');
+		}
+	}
+
+	template<size_t TPrecision = 2, std::ranges::random_access_range TRange>
+		requires std::ranges::sized_range<TRange>
+			&& JsonSerializable<std::ranges::range_value_t<TRange>>
+	std::string serialize_json_batch(
+		const TRange& values,
+		JsonBatchFormat format = JsonBatchFormat::Array,
+		std::size_t threads = 0
+	) {
+		std::string out;
+		serialize_json_batch<TPrecision>(values, out, format, threads);
+		return out;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <bit> 			// endian, byteswap, bit_cast
+#include <cstddef> 		// byte
+#include <cstring> 		// memcpy
+#include <limits>
+#include <span>
+#include <stdexcept> 	// length_error
+#include <string_view>
+#include <vector>
+
+namespace kser {
+	// The binary layout is compact and has no names or tags:
+	// - bools are one byte
+	// - other arithmetic types are their little-endian bytes
+	// - strings are a little-endian u32 length followed by the characters
+	// - reflected structs are their serializable NamedFields, in order
+	template<typename T>
+	concept BinarySerializable =
+		std::is_arithmetic_v<T>
+		|| IsString<T>
+		|| Reflectable<T>;
+
+	namespace detail {
+		// fields whose in-memory bytes are already the serialized bytes,
+		// so adjacent ones can be copied in one go
+		template<typename T>
+		concept BinaryCoalescable =
+			std::endian::native == std::endian::little
+			&& std::is_arithmetic_v<T>
+			&& !std::same_as<T, bool>;
+
+		// value with its bytes in the given order
+		template<std::endian Order, typename T>
+		constexpr T to_endian(T value) {
+			if constexpr (std::endian::native != Order && sizeof(T) > 1) {
+				if constexpr (std::integral<T>) {
+					return std::byteswap(value);
+				}
+				else {
+					using bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+					return std::bit_cast<T>(std::byteswap(std::bit_cast<bits_t>(value)));
+				}
+			}
+			else {
+				return value;
+			}
+		}
+
+		template<typename T>
+		constexpr T to_little_endian(T value) {
+			return to_endian<std::endian::little>(value);
+		}
+
+		struct BinaryWriter {
+			std::vector<std::byte>& out;
+
+			void write(const void* data, std::size_t size) {
+				auto bytes = static_cast<const std::byte*>(data);
+				out.insert(out.end(), bytes, bytes + size);
+			}
+
+			template<typename T>
+			void write_scalar(T value) {
+				value = to_little_endian(value);
+				write(&value, sizeof(T));
+			}
+
+			void put(std::uint8_t byte) {
+				out.push_back(std::byte{byte});
+			}
+
+			// for formats such as MessagePack and CBOR
+			template<typename T>
+			void write_big_endian(T value) {
+				value = to_endian<std::endian::big>(value);
+				write(&value, sizeof(T));
+			}
+		};
+
+		struct BinaryReader {
+			std::span<const std::byte> in;
+			std::size_t pos = 0;
+
+			const std::byte* take(std::size_t size) {
+				if (in.size() - pos < size) {
+					throw ParseError("Unexpected end of input", pos);
+				}
+				auto out = in.data() + pos;
+				pos += size;
+				return out;
+			}
+
+			template<typename T>
+			T read_scalar() {
+				T value;
+				std::memcpy(&value, take(sizeof(T)), sizeof(T));
+				return to_little_endian(value);
+			}
+		};
+
+		template<typename T>
+		void write_binary(BinaryWriter& writer, const T& value) {
+			if constexpr (std::same_as<T, bool>) {
+				writer.write_scalar(static_cast<std::uint8_t>(value));
+			}
+			else if constexpr (std::is_arithmetic_v<T>) {
+				writer.write_scalar(value);
+			}
+			else if constexpr (IsString<T>) {
+				std::string_view s = value;
+				// the length prefix is 32 bits, and a truncated one couldn't be read back
+				if (s.size() > std::numeric_limits<std::uint32_t>::max()) {
+					throw std::length_error("String too long for binary serialization");
+				}
+				writer.write_scalar(static_cast<std::uint32_t>(s.size()));
+				writer.write(s.data(), s.size());
+			}
+			else if constexpr (Reflectable<T>) {
+				// a run of coalescable fields that are contiguous in memory
+				const std::byte* run_begin = nullptr;
+				const std::byte* run_end = nullptr;
+				auto flush = [&] {
+					if (run_begin != run_end) {
+						writer.write(run_begin, run_end - run_begin);
+					}
+					run_begin = run_end = nullptr;
+				};
+				auto visitor = [&](const auto& field) {
+					using value_t = std::remove_cvref_t<decltype(field.value)>;
+					if constexpr (BinaryCoalescable<value_t>) {
+						auto p = reinterpret_cast<const std::byte*>(&field.value);
+						if (p != run_end) {
+							flush();
+							run_begin = p;
+						}
+						run_end = p + sizeof(value_t);
+					}
+					else if constexpr (BinarySerializable<value_t>) {
+						flush();
+						write_binary(writer, field.value);
+					}
+				};
+				kser::visit_fields(value, visitor);
+				flush();
+			}
+		}
+
+		template<typename T>
+		void read_binary(BinaryReader& reader, T& value) {
+			if constexpr (std::same_as<T, bool>) {
+				value = reader.read_scalar<std::uint8_t>() != 0;
+			}
+			else if constexpr (std::is_arithmetic_v<T>) {
+				value = reader.read_scalar<T>();
+			}
+			else if constexpr (IsString<T>) {
+				auto size = reader.read_scalar<std::uint32_t>();
+				auto data = reader.take(size);
+				value.assign(reinterpret_cast<const char*>(data), size);
+			}
+			else if constexpr (Reflectable<T>) {
+				std::byte* run_begin = nullptr;
+				std::byte* run_end = nullptr;
+				auto flush = [&] {
+					if (run_begin != run_end) {
+						auto size = static_cast<std::size_t>(run_end - run_begin);
+						std::memcpy(run_begin, reader.take(size), size);
+					}
+					run_begin = run_end = nullptr;
+				};
+				auto visitor = [&](auto& field) {
+					using value_t = std::remove_cvref_t<decltype(field.value)>;
+					if constexpr (BinaryCoalescable<value_t>) {
+						auto p = reinterpret_cast<std::byte*>(&field.value);
+						if (p != run_end) {
+							flush();
+							run_begin = p;
+						}
+						run_end = p + sizeof(value_t);
+					}
+					else if constexpr (BinarySerializable<value_t>) {
+						flush();
+						read_binary(reader, field.value);
+					}
+				};
+				kser::visit_fields(value, visitor);
+				flush();
+			}
+		}
+	}
+
+	// Appends the binary form of value to out. Throws std::length_error for a
+	// string of 2^32 characters or more, whose length doesn't fit the format.
+	template<typename T>
+		requires BinarySerializable<T>
+	void serialize_binary(const T& value, std::vector<std::byte>& out) {
+		detail::BinaryWriter writer{out};
+		detail::write_binary(writer, value);
+	}
+
+	template<typename T>
+		requires BinarySerializable<T>
+	std::vector<std::byte> serialize_binary(const T& value) {
+		std::vector<std::byte> out;
+		serialize_binary(value, out);
+		return out;
+	}
+
+	// Reads one value from the front of in, returning the number of bytes read.
+	// Throws ParseError if in is too short.
+	template<typename T>
+		requires BinarySerializable<T>
+	std::size_t deserialize_binary(std::span<const std::byte> in, T& out) {
+		detail::InstrumentScope<T> scope(Operation::DeserializeBinary);
+		detail::BinaryReader reader{in};
+		detail::read_binary(reader, out);
+		scope.add_bytes(reader.pos);
+		return reader.pos;
+	}
+
+	template<typename T>
+		requires BinarySerializable<T> && std::default_initializable<T>
+	T deserialize_binary(std::span<const std::byte> in) {
+		T out{};
+		deserialize_binary(in, out);
+		return out;
+	}
+
+	// Reads into a struct from make_with_resource, so its strings allocate from resource.
+	template<typename T>
+		requires Reflectable<T>
+	T deserialize_binary(std::span<const std::byte> in, std::pmr::memory_resource* resource) {
+		auto out = make_with_resource<T>(resource);
+		deserialize_binary(in, out);
+		return out;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <kser/binary.hpp>
+#include <kser/serialize.hpp>
+#include <cstddef> 		// byte
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace kser {
+	// Writes CBOR (RFC 8949): structs and maps are maps with text string keys,
+	// arrays and maps have definite lengths, and integers use their smallest
+	// encoding. floats are single precision and other floating point types
+	// double precision.
+	class CborWriter {
+	public:
+		explicit CborWriter(std::vector<std::byte>& out) : writer{out} {}
+
+		void null() {
+			writer.put(0xf6);
+		}
+
+		void boolean(bool value) {
+			writer.put(value ? 0xf5 : 0xf4);
+		}
+
+		template<typename V>
+			requires std::is_arithmetic_v<V>
+		void number(V value) {
+			if constexpr (std::floating_point<V>) {
+				if constexpr (sizeof(V) <= sizeof(float)) {
+					writer.put(0xfa);
+					writer.write_big_endian(static_cast<float>(value));
+				}
+				else {
+					writer.put(0xfb);
+					writer.write_big_endian(static_cast<double>(value));
+				}
+			}
+			else if constexpr (std::is_signed_v<V>) {
+				if (value >= 0) {
+					write_head(MajorType::Unsigned, static_cast<std::uint64_t>(value));
+				}
+				else {
+					// -1 - n, which can't overflow
+					write_head(MajorType::Negative, static_cast<std::uint64_t>(-(static_cast<std::int64_t>(value) + 1)));
+				}
+			}
+			else {
+				write_head(MajorType::Unsigned, static_cast<std::uint64_t>(value));
+			}
+		}
+
+		void string(std::string_view s) {
+			write_head(MajorType::Text, s.size());
+			writer.write(s.data(), s.size());
+		}
+
+		void begin_array(std::size_t size) {
+			write_head(MajorType::Array, size);
+		}
+
+		void end_array() {}
+
+		void begin_object(std::size_t size) {
+			write_head(MajorType::Map, size);
+		}
+
+		void key(std::string_view key) {
+			string(key);
+		}
+
+		void key(std::integral auto key) {
+			number(key);
+		}
+
+		void end_object() {}
+
+	private:
+		enum class MajorType : std::uint8_t {
+			Unsigned = 0,
+			Negative = 1,
+			Text = 3,
+			Array = 4,
+			Map = 5,
+		};
+
+		// the major type and an argument, in the fewest bytes
+		void write_head(MajorType type, std::uint64_t argument) {
+			auto major = static_cast<std::uint8_t>(static_cast<std::uint8_t>(type) << 5);
+			if (argument < 24) {
+				writer.put(static_cast<std::uint8_t>(major | argument));
+			}
+			else if (argument <= 0xff) {
+				writer.put(major | 24);
+				writer.put(static_cast<std::uint8_t>(argument));
+			}
+			else if (argument <= 0xffff) {
+				writer.put(major | 25);
+				writer.write_big_endian(static_cast<std::uint16_t>(argument));
+			}
+			else if (argument <= 0xffffffff) {
+				writer.put(major | 26);
+				writer.write_big_endian(static_cast<std::uint32_t>(argument));
+			}
+			else {
+				writer.put(major | 27);
+				writer.write_big_endian(argument);
+			}
+		}
+
+		detail::BinaryWriter writer;
+	};
+
+	// Appends value as CBOR to out.
+	template<typename T>
+		requires JsonSerializable<T>
+	void serialize_cbor(const T& value, std::vector<std::byte>& out) {
+		CborWriter writer{out};
+		serialize(writer, value);
+	}
+
+	template<typename T>
+		requires JsonSerializable<T>
+	std::vector<std::byte> serialize_cbor(const T& value) {
+		std::vector<std::byte> out;
+		serialize_cbor(value, out);
+		return out;
+	}
+}
\ No newline at end of file
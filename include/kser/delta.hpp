@@ -0,0 +1,111 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <kser/binary.hpp>
+#include <cstring> 		// memcmp
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace kser {
+	namespace detail {
+		// whether a and b have the same binary form
+		template<typename T>
+		constexpr bool binary_equal(const T& a, const T& b) {
+			if constexpr (std::floating_point<T>) {
+				// bitwise, so NaNs don't count as changed every time
+				return std::memcmp(&a, &b, sizeof(T)) == 0;
+			}
+			else if constexpr (std::is_arithmetic_v<T>) {
+				return a == b;
+			}
+			else if constexpr (IsString<T>) {
+				return std::string_view(a) == std::string_view(b);
+			}
+			else if constexpr (Reflectable<T>) {
+				return []<std::size_t... I>(const T& a, const T& b, std::index_sequence<I...>) {
+					auto& [...x] = a;
+					auto& [...y] = b;
+					return (... && [&] {
+						if constexpr (BinarySerializable<field_value_at_t<T, I>>) {
+							return binary_equal(
+								x...[field_members<T>[I]].value,
+								y...[field_members<T>[I]].value
+							);
+						}
+						else {
+							return true;
+						}
+					}());
+				}(a, b, std::make_index_sequence<field_members<T>.size()>{});
+			}
+			else {
+				return true;
+			}
+		}
+
+		template<typename T>
+		inline constexpr std::size_t delta_mask_size = (field_members<T>.size() + 7) / 8;
+	}
+
+	// A delta is a bitmask with a bit per NamedField, in declaration order,
+	// followed by the binary form of each changed field:
+	// [mask bytes][changed field][changed field]...
+	// Fields that aren't binary serializable are never marked as changed.
+
+	// Appends the delta from from to to, returning whether any field changed.
+	template<typename T>
+		requires Reflectable<T>
+	bool diff(const T& from, const T& to, std::vector<std::byte>& out) {
+		auto mask_pos = out.size();
+		out.resize(mask_pos + detail::delta_mask_size<T>);
+		detail::BinaryWriter writer{out};
+		bool changed = false;
+		[&]<std::size_t... I>(std::index_sequence<I...>) {
+			auto& [...x] = from;
+			auto& [...y] = to;
+			([&] {
+				if constexpr (BinarySerializable<detail::field_value_at_t<T, I>>) {
+					auto& from_value = x...[detail::field_members<T>[I]].value;
+					auto& to_value = y...[detail::field_members<T>[I]].value;
+					if (!detail::binary_equal(from_value, to_value)) {
+						// out may have been reallocated by an earlier field
+						out[mask_pos + I / 8] |= std::byte{1} << (I % 8);
+						detail::write_binary(writer, to_value);
+						changed = true;
+					}
+				}
+			}(), ...);
+		}(std::make_index_sequence<detail::field_members<T>.size()>{});
+		return changed;
+	}
+
+	template<typename T>
+		requires Reflectable<T>
+	std::vector<std::byte> diff(const T& from, const T& to) {
+		std::vector<std::byte> out;
+		diff(from, to, out);
+		return out;
+	}
+
+	// Applies a delta from the front of in to out, returning the number of bytes read.
+	// Throws ParseError if in is too short.
+	template<typename T>
+		requires Reflectable<T>
+	std::size_t apply_delta(std::span<const std::byte> in, T& out) {
+		detail::BinaryReader reader{in};
+		auto mask = reader.take(detail::delta_mask_size<T>);
+		std::size_t i = 0;
+		auto visitor = [&](auto& field) {
+			using value_t = std::remove_cvref_t<decltype(field.value)>;
+			if constexpr (BinarySerializable<value_t>) {
+				if (std::to_integer<unsigned>(mask[i / 8]) & (1u << (i % 8))) {
+					detail::read_binary(reader, field.value);
+				}
+			}
+			++i;
+		};
+		visit_fields(out, visitor);
+		return reader.pos;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <algorithm> 	// is_permutation
+#include <bit> 			// rotl
+#include <cstddef> 		// byte
+#include <cstdint>
+#include <cstring> 		// memcpy, memcmp
+#include <functional> 	// hash
+#include <ranges>
+
+namespace kser {
+	namespace detail {
+		// values that are equal exactly when their bytes are, so adjacent ones
+		// can be hashed and compared as one block of memory (not floats, where
+		// 0.0 == -0.0, or anything with padding)
+		template<typename T>
+		concept BytewiseComparable =
+			std::is_scalar_v<T>
+			&& std::has_unique_object_representations_v<T>;
+
+		// unordered containers, whose iteration order says nothing about equality
+		template<typename T>
+		concept IsUnordered = std::ranges::input_range<T> && requires { typename T::hasher; };
+
+		constexpr std::uint64_t hash_combine(std::uint64_t h, std::uint64_t x) {
+			return mix_hash(h ^ x, 1);
+		}
+
+		inline std::uint64_t read_word(const std::byte* data) {
+			std::uint64_t word;
+			std::memcpy(&word, data, sizeof(word));
+			return word;
+		}
+
+		constexpr std::uint64_t hash_word(std::uint64_t h, std::uint64_t word) {
+			h = (h ^ word) * 0x9fb21c651e98df25ull;
+			return h ^ (h >> 29);
+		}
+
+		// Hashes a block of memory 8 bytes at a time, in four independent lanes
+		// so the multiplies of consecutive words overlap (and can be vectorized),
+		// then the remaining words, then the tail as one zero-padded word.
+		inline std::uint64_t hash_bytes(const void* p, std::size_t size, std::uint64_t h) {
+			auto data = static_cast<const std::byte*>(p);
+			std::size_t i = 0;
+			if (size >= 32) {
+				std::uint64_t lanes[4] = {h, h ^ 0x9e3779b97f4a7c15ull, ~h, h + size};
+				for (; i + 32 <= size; i += 32) {
+					for (std::size_t lane = 0; lane < 4; ++lane) {
+						lanes[lane] = hash_word(lanes[lane], read_word(data + i + lane * 8));
+					}
+				}
+				h = lanes[0]
+					^ std::rotl(lanes[1], 16)
+					^ std::rotl(lanes[2], 32)
+					^ std::rotl(lanes[3], 48);
+			}
+			for (; i + 8 <= size; i += 8) {
+				h = hash_word(h, read_word(data + i));
+			}
+			if (i < size) {
+				std::uint64_t tail = 0;
+				std::memcpy(&tail, data + i, size - i);
+				h = hash_word(h, tail);
+			}
+			return hash_combine(h, size);
+		}
+
+		template<typename T>
+		std::uint64_t hash_fields(const T& value, std::uint64_t h);
+
+		template<typename T>
+		bool equal_fields(const T& a, const T& b);
+
+		template<typename T>
+		std::uint64_t hash_value(const T& value, std::uint64_t h) {
+			if constexpr (Reflectable<T>) {
+				return hash_fields(value, h);
+			}
+			else if constexpr (BytewiseComparable<T> && sizeof(T) <= sizeof(std::uint64_t)) {
+				std::uint64_t bits = 0;
+				std::memcpy(&bits, &value, sizeof(T));
+				return hash_combine(h, bits);
+			}
+			else if constexpr (IsOptional<T>) {
+				return value ? hash_value(*value, hash_combine(h, 1)) : hash_combine(h, 0);
+			}
+			else if constexpr (requires { value.first; value.second; }) {
+				return hash_value(value.second, hash_value(value.first, h));
+			}
+			else if constexpr (IsUnordered<T>) {
+				// the same whatever order the elements are in
+				std::uint64_t sum = 0;
+				std::uint64_t n = 0;
+				for (const auto& element : value) {
+					sum += hash_value(element, 0);
+					++n;
+				}
+				return hash_combine(hash_combine(h, sum), n);
+			}
+			else if constexpr (std::ranges::input_range<T>) {
+				using element_t = std::ranges::range_value_t<T>;
+				if constexpr (std::ranges::contiguous_range<const T> && BytewiseComparable<element_t>) {
+					return hash_bytes(std::ranges::data(value), std::ranges::size(value) * sizeof(element_t), h);
+				}
+				else {
+					std::uint64_t n = 0;
+					for (const auto& element : value) {
+						// converts proxies such as std::vector<bool>'s
+						h = hash_value(static_cast<const element_t&>(element), h);
+						++n;
+					}
+					return hash_combine(h, n);
+				}
+			}
+			else {
+				// floats (std::hash treats 0.0 and -0.0 the same) and anything else with a std::hash
+				return hash_combine(h, std::hash<T>{}(value));
+			}
+		}
+
+		template<typename T>
+		bool equal_value(const T& a, const T& b) {
+			if constexpr (Reflectable<T>) {
+				return equal_fields(a, b);
+			}
+			else if constexpr (IsOptional<T>) {
+				return a.has_value() == b.has_value() && (!a || equal_value(*a, *b));
+			}
+			else if constexpr (requires { a.first; a.second; }) {
+				return equal_value(a.first, b.first) && equal_value(a.second, b.second);
+			}
+			else if constexpr (IsUnordered<T>) {
+				if (a.size() != b.size()) {
+					return false;
+				}
+				// elements with equal keys are adjacent, so each group is compared
+				// with the same key's group in b, in any order, which also works
+				// for multisets and multimaps
+				for (auto it = a.begin(); it != a.end();) {
+					const auto& key = [&]() -> const auto& {
+						if constexpr (IsMap<T>) {
+							return it->first;
+						}
+						else {
+							return *it;
+						}
+					}();
+					auto [a_first, a_last] = a.equal_range(key);
+					auto [b_first, b_last] = b.equal_range(key);
+					auto same = std::is_permutation(
+						a_first, a_last,
+						b_first, b_last,
+						[](const auto& x, const auto& y) { return equal_value(x, y); }
+					);
+					if (!same) {
+						return false;
+					}
+					it = a_last;
+				}
+				return true;
+			}
+			else if constexpr (std::ranges::input_range<T>) {
+				using element_t = std::ranges::range_value_t<T>;
+				if constexpr (std::ranges::contiguous_range<const T> && BytewiseComparable<element_t>) {
+					auto size = std::ranges::size(a);
+					return size == std::ranges::size(b)
+						&& (size == 0 || std::memcmp(std::ranges::data(a), std::ranges::data(b), size * sizeof(element_t)) == 0);
+				}
+				else {
+					auto ia = std::ranges::begin(a);
+					auto ib = std::ranges::begin(b);
+					for (; ia != std::ranges::end(a) && ib != std::ranges::end(b); ++ia, ++ib) {
+						if (!equal_value(static_cast<const element_t&>(*ia), static_cast<const element_t&>(*ib))) {
+							return false;
+						}
+					}
+					return ia == std::ranges::end(a) && ib == std::ranges::end(b);
+				}
+			}
+			else {
+				return a == b;
+			}
+		}
+
+		template<typename T>
+		std::uint64_t hash_fields(const T& value, std::uint64_t h) {
+			// a run of bytewise comparable fields that are contiguous in memory
+			const std::byte* run_begin = nullptr;
+			const std::byte* run_end = nullptr;
+			auto flush = [&] {
+				if (run_begin != run_end) {
+					h = hash_bytes(run_begin, run_end - run_begin, h);
+				}
+				run_begin = run_end = nullptr;
+			};
+			auto visitor = [&](const auto& field) {
+				using value_t = std::remove_cvref_t<decltype(field.value)>;
+				if constexpr (BytewiseComparable<value_t>) {
+					auto p = reinterpret_cast<const std::byte*>(&field.value);
+					if (p != run_end) {
+						flush();
+						run_begin = p;
+					}
+					run_end = p + sizeof(value_t);
+				}
+				else {
+					flush();
+					h = hash_value(field.value, h);
+				}
+			};
+			kser::visit_fields(value, visitor);
+			flush();
+			return h;
+		}
+
+		template<typename T>
+		bool equal_fields(const T& a, const T& b) {
+			return [&]<std::size_t... I>(std::index_sequence<I...>) {
+				auto& [...x] = a;
+				auto& [...y] = b;
+				auto a_base = reinterpret_cast<const std::byte*>(&a);
+				auto b_base = reinterpret_cast<const std::byte*>(&b);
+				const std::byte* run_begin = nullptr;
+				const std::byte* run_end = nullptr;
+				// compares the run with the bytes at the same offset in b
+				auto flush = [&] {
+					bool same = run_begin == run_end
+						|| std::memcmp(run_begin, b_base + (run_begin - a_base), run_end - run_begin) == 0;
+					run_begin = run_end = nullptr;
+					return same;
+				};
+				return (... && [&] {
+					using value_t = field_value_at_t<T, I>;
+					auto& from = x...[field_members<T>[I]].value;
+					if constexpr (BytewiseComparable<value_t>) {
+						auto p = reinterpret_cast<const std::byte*>(&from);
+						if (p != run_end) {
+							if (!flush()) {
+								return false;
+							}
+							run_begin = p;
+						}
+						run_end = p + sizeof(value_t);
+						return true;
+					}
+					else {
+						return flush() && equal_value(from, y...[field_members<T>[I]].value);
+					}
+				}()) && flush();
+			}(std::make_index_sequence<field_members<T>.size()>{});
+		}
+	}
+
+	// Hash of the NamedFields of value, recursing into nested structs,
+	// optionals and containers; members that aren't NamedFields are ignored.
+	// Runs of adjacent integer, enum and pointer fields are hashed as raw
+	// bytes. Values that are equal have the same hash, but hashes aren't
+	// stable between builds or platforms, so don't store them.
+	template<typename T>
+		requires Reflectable<T>
+	std::uint64_t hash(const T& value) {
+		return detail::hash_fields(value, 0x243f6a8885a308d3ull);
+	}
+
+	// Whether every NamedField of a equals the same field of b, recursing like
+	// hash. Runs of adjacent integer, enum and pointer fields are compared with
+	// one memcmp; floats are compared with ==.
+	template<typename T>
+		requires Reflectable<T>
+	bool equal(const T& a, const T& b) {
+		return detail::equal_fields(a, b);
+	}
+
+	// for reflected structs as keys, as in std::unordered_map<Key, V, kser::Hash, kser::Equal>
+	struct Hash {
+		template<typename T>
+			requires Reflectable<T>
+		std::size_t operator ()(const T& value) const {
+			return static_cast<std::size_t>(hash(value));
+		}
+	};
+
+	struct Equal {
+		template<typename T>
+			requires Reflectable<T>
+		bool operator ()(const T& a, const T& b) const {
+			return equal(a, b);
+		}
+	};
+}
\ No newline at end of file
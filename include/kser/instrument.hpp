@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm> 	// min, max
+#include <array>
+#include <atomic>
+#include <bit> 			// bit_width
+#include <chrono>
+#include <cstdint>
+#include <memory> 		// unique_ptr
+#include <mutex>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <utility> 		// to_underlying
+#include <vector>
+
+// Counters for how often, how long and how many bytes serialize_json,
+// parse_json, JsonStreamParser, deserialize_binary, deserialize_tagged,
+// set_values and get_value_map take for each type. They are
+// compiled out unless KSER_INSTRUMENT is defined (the KSER_INSTRUMENT CMake
+// option defines it for everything linking KSer), in which case each call
+// costs two clock reads and a few relaxed atomic adds.
+
+namespace kser {
+#ifdef KSER_INSTRUMENT
+	inline constexpr bool instrumentation_enabled = true;
+#else
+	inline constexpr bool instrumentation_enabled = false;
+#endif
+
+	enum class Operation : std::uint8_t {
+		SerializeJson,
+		ParseJson,
+		SetValues,
+		GetValueMap,
+		// one call per JsonStreamParser::feed or finish
+		ParseJsonStream,
+		DeserializeBinary,
+		DeserializeTagged,
+	};
+
+	inline constexpr std::size_t operation_count = 7;
+
+	// latency[0] counts calls under 1ns, and latency[i] calls taking
+	// [2^(i-1), 2^i) ns, with the last bucket taking anything slower
+	inline constexpr std::size_t latency_buckets = 40;
+
+	struct OperationStats {
+		std::uint64_t calls = 0;
+		// written by serialize_json, read by the parsers and deserializers
+		std::uint64_t bytes = 0;
+		std::array<std::uint64_t, latency_buckets> latency{};
+	};
+
+	struct FieldStats {
+		std::string_view name;
+		// indexed by Operation; serialize_json, parse_json and
+		// deserialize_tagged count bytes
+		std::array<std::uint64_t, operation_count> calls{};
+		std::array<std::uint64_t, operation_count> bytes{};
+	};
+
+	// Counters for the calls made with one type as the top-level value. Nested
+	// structs show up in the fields of the struct containing them.
+	struct TypeStats {
+		std::string_view name;
+		std::array<OperationStats, operation_count> operations{};
+		std::vector<FieldStats> fields;
+
+		const OperationStats& operator [](Operation op) const {
+			return operations[std::to_underlying(op)];
+		}
+	};
+
+	namespace detail {
+		template<typename T>
+		constexpr std::string_view raw_type_name() {
+			return std::source_location::current().function_name();
+		}
+
+		// where the type appears in raw_type_name's function name
+		inline constexpr std::size_t type_name_prefix = raw_type_name<double>().find("double");
+		inline constexpr std::size_t type_name_suffix =
+			raw_type_name<double>().size() - type_name_prefix - std::string_view{"double"}.size();
+
+		// T as the compiler spells it, such as "Player" or "game::Player"
+		template<typename T>
+		constexpr std::string_view type_name() {
+			auto raw = raw_type_name<T>();
+			return raw.substr(type_name_prefix, raw.size() - type_name_prefix - type_name_suffix);
+		}
+
+#ifdef KSER_INSTRUMENT
+		struct AtomicOperationStats {
+			std::atomic<std::uint64_t> calls{0};
+			std::atomic<std::uint64_t> bytes{0};
+			std::array<std::atomic<std::uint64_t>, latency_buckets> latency{};
+		};
+
+		struct AtomicFieldStats {
+			std::array<std::atomic<std::uint64_t>, operation_count> calls{};
+			std::array<std::atomic<std::uint64_t>, operation_count> bytes{};
+		};
+
+		// The counters for one type, which add themselves to the registry's
+		// list when the type is first used, and are never removed.
+		struct TypeCounters {
+			std::string_view name;
+			std::span<const std::string_view> field_names;
+			std::array<AtomicOperationStats, operation_count> operations;
+			std::unique_ptr<AtomicFieldStats[]> fields;
+			TypeCounters* next = nullptr;
+
+			TypeCounters(std::string_view name, std::span<const std::string_view> field_names);
+		};
+
+		struct InstrumentRegistry {
+			std::mutex mutex;
+			TypeCounters* head = nullptr;
+		};
+
+		inline InstrumentRegistry& instrument_registry() {
+			static InstrumentRegistry registry;
+			return registry;
+		}
+
+		inline TypeCounters::TypeCounters(std::string_view name, std::span<const std::string_view> field_names)
+			: name(name),
+			field_names(field_names),
+			fields(std::make_unique<AtomicFieldStats[]>(field_names.size())) {
+			auto& registry = instrument_registry();
+			std::lock_guard lock(registry.mutex);
+			next = registry.head;
+			registry.head = this;
+		}
+
+		inline void count(std::atomic<std::uint64_t>& counter, std::uint64_t n) {
+			counter.fetch_add(n, std::memory_order_relaxed);
+		}
+
+		inline void record_call(
+			TypeCounters& counters,
+			Operation op,
+			std::chrono::nanoseconds latency,
+			std::size_t bytes
+		) {
+			auto& stats = counters.operations[std::to_underlying(op)];
+			auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+			auto bucket = std::min<std::size_t>(std::bit_width(ns), latency_buckets - 1);
+			count(stats.calls, 1);
+			count(stats.bytes, bytes);
+			count(stats.latency[bucket], 1);
+		}
+
+		inline void record_field(TypeCounters& counters, Operation op, std::size_t field, std::size_t bytes) {
+			if (field < counters.field_names.size()) {
+				count(counters.fields[field].calls[std::to_underlying(op)], 1);
+				count(counters.fields[field].bytes[std::to_underlying(op)], bytes);
+			}
+		}
+#endif
+	}
+
+	// The counters of every type used since startup, in no particular order.
+	// Types appear from their first call, and stay after reset_instrumentation.
+	// Empty unless KSER_INSTRUMENT is defined.
+	inline std::vector<TypeStats> instrumentation_snapshot() {
+		std::vector<TypeStats> out;
+#ifdef KSER_INSTRUMENT
+		auto load = [](const std::atomic<std::uint64_t>& counter) {
+			return counter.load(std::memory_order_relaxed);
+		};
+		auto& registry = detail::instrument_registry();
+		std::lock_guard lock(registry.mutex);
+		for (auto counters = registry.head; counters; counters = counters->next) {
+			auto& stats = out.emplace_back();
+			stats.name = counters->name;
+			for (std::size_t op = 0; op < operation_count; ++op) {
+				auto& from = counters->operations[op];
+				stats.operations[op].calls = load(from.calls);
+				stats.operations[op].bytes = load(from.bytes);
+				for (std::size_t i = 0; i < latency_buckets; ++i) {
+					stats.operations[op].latency[i] = load(from.latency[i]);
+				}
+			}
+			for (std::size_t i = 0; i < counters->field_names.size(); ++i) {
+				auto& field = stats.fields.emplace_back();
+				field.name = counters->field_names[i];
+				for (std::size_t op = 0; op < operation_count; ++op) {
+					field.calls[op] = load(counters->fields[i].calls[op]);
+					field.bytes[op] = load(counters->fields[i].bytes[op]);
+				}
+			}
+		}
+#endif
+		return out;
+	}
+
+	// Zeroes every counter. Calls running at the same time may be partly counted.
+	inline void reset_instrumentation() {
+#ifdef KSER_INSTRUMENT
+		auto& registry = detail::instrument_registry();
+		std::lock_guard lock(registry.mutex);
+		for (auto counters = registry.head; counters; counters = counters->next) {
+			for (auto& stats : counters->operations) {
+				stats.calls = 0;
+				stats.bytes = 0;
+				for (auto& bucket : stats.latency) {
+					bucket = 0;
+				}
+			}
+			for (std::size_t i = 0; i < counters->field_names.size(); ++i) {
+				for (std::size_t op = 0; op < operation_count; ++op) {
+					counters->fields[i].calls[op] = 0;
+					counters->fields[i].bytes[op] = 0;
+				}
+			}
+		}
+#endif
+	}
+}
\ No newline at end of file
@@ -1,13 +1,25 @@
 #pragma once
 
+#include <kser/instrument.hpp>
 #include <algorithm> 	// copy
+#include <string>
 #include <string_view>
 #include <concepts>
+#include <expected>
+#include <type_traits>
 #include <variant>
 #include <any>
 #include <optional>
+#include <ranges>
 #include <stdexcept> 	// runtime_error
 #include <functional> 	// reference wrapper
+#include <memory> 		// make_obj_using_allocator, construct_at
+#include <memory_resource>
+#include <array>
+#include <bit> 			// bit_ceil
+#include <cstdint>
+#include <utility> 		// index_sequence
+#include <vector>
 
 namespace kser {
 	struct FieldNotFound : std::runtime_error {
@@ -20,6 +32,28 @@ namespace kser {
 			: std::runtime_error("Field type mismatch: " + std::string(name)) {}
 	};
 
+	enum class ErrorCode : std::uint8_t {
+		FieldNotFound,
+		TypeMismatch,
+	};
+
+	// A failed lookup, returned by the *_expected accessors instead of thrown,
+	// so misses don't unwind or allocate. name views the name or path passed
+	// in (or the key of the input map), so it is only valid as long as that is.
+	struct Error {
+		ErrorCode code;
+		std::string_view name;
+	};
+
+	struct ParseError : std::runtime_error {
+		std::size_t offset;
+
+		ParseError(std::string_view what, std::size_t offset)
+			: std::runtime_error(
+				"Parse error at " + std::to_string(offset) + ": " + std::string(what)
+			), offset(offset) {}
+	};
+
 	template<size_t N>
 	struct StaticString {
 		char value[N];
@@ -42,27 +76,513 @@ namespace kser {
 	template<typename T>
 	concept IsField = std::derived_from<T, Field<typename T::type>>;
 
+	// types whose fields can be visited (plain aggregates, other than std::array)
+	template<typename T>
+	concept Reflectable =
+		std::is_class_v<T>
+		&& std::is_aggregate_v<T>
+		&& !IsField<T>
+		&& !std::ranges::range<T>;
+
+	// strings that own their characters
+	template<typename T>
+	concept IsString =
+		std::convertible_to<const T&, std::string_view>
+		&& requires(T& s, const char* data, std::size_t size) {
+			s.assign(data, size);
+		};
+
+	template<typename T>
+	concept IsOptional =
+		requires { typename T::value_type; }
+		&& std::same_as<T, std::optional<typename T::value_type>>;
+
+	// ranges of key/value pairs
+	template<typename T>
+	concept IsMap =
+		std::ranges::input_range<T>
+		&& requires {
+			typename T::key_type;
+			typename T::mapped_type;
+		};
+
+	// any other range, including strings
+	template<typename T>
+	concept IsSequence = std::ranges::input_range<T> && !IsMap<T>;
+
 	template<typename T, StaticString Name>
 	struct NamedField : Field<T> {
-		std::string_view field_name() const {
+		static constexpr std::string_view field_name() {
 			return Name.string_view();
 		}
 	};
 
+	namespace detail {
+		template<typename... Ts>
+		struct TypeList {
+			static constexpr std::size_t size = sizeof...(Ts);
+
+			template<std::size_t I>
+			using at = Ts...[I];
+		};
+
+		// only used in unevaluated contexts to get the types of the members
+		template<typename T>
+		auto member_types(T& s) {
+			auto& [...x] = s;
+			return TypeList<std::remove_cvref_t<decltype(x)>...>{};
+		}
+
+		template<typename T>
+		using member_types_t = decltype(member_types(std::declval<T&>()));
+
+		// indices of the members that are fields, in declaration order
+		template<typename T>
+		inline constexpr auto field_members = []<std::size_t... I>(std::index_sequence<I...>) {
+			using members_t = member_types_t<T>;
+			constexpr std::size_t count = (
+				0 + ... + std::size_t{IsField<typename members_t::template at<I>>}
+			);
+			std::array<std::size_t, count> out{};
+			std::size_t n = 0;
+			((IsField<typename members_t::template at<I>> ? void(out[n++] = I) : void()), ...);
+			return out;
+		}(std::make_index_sequence<member_types_t<T>::size>{});
+
+		// type of the I-th field of T, counting only fields
+		template<typename T, std::size_t I>
+		using field_at_t = typename member_types_t<T>::template at<field_members<T>[I]>;
+
+		template<typename T, std::size_t I>
+		using field_value_at_t = typename field_at_t<T, I>::type;
+
+		template<typename T>
+		inline constexpr auto field_names = []<std::size_t... I>(std::index_sequence<I...>) {
+			return std::array<std::string_view, sizeof...(I)>{
+				field_at_t<T, I>::field_name()...
+			};
+		}(std::make_index_sequence<field_members<T>.size()>{});
+
+		// FNV-1a, only computed once per lookup
+		constexpr std::uint64_t hash_name(std::string_view name) {
+			std::uint64_t h = 0xcbf29ce484222325ull;
+			for (char c : name) {
+				h ^= static_cast<unsigned char>(c);
+				h *= 0x100000001b3ull;
+			}
+			return h;
+		}
+
+		// splitmix64 finalizer, used to derive both levels of the table from one hash
+		constexpr std::uint64_t mix_hash(std::uint64_t h, std::uint64_t seed) {
+			h ^= seed * 0x9e3779b97f4a7c15ull;
+			h ^= h >> 30;
+			h *= 0xbf58476d1ce4e5b9ull;
+			h ^= h >> 27;
+			h *= 0x94d049bb133111ebull;
+			h ^= h >> 31;
+			return h;
+		}
+
+		// Perfect hash (hash and displace) of a fixed set of names, built at compile time.
+		// A name is hashed into a bucket, and the bucket's displacement either
+		// names its slot directly (negative) or is the seed to rehash with.
+		// Lookups always compare against the stored name, so misses are cheap and exact.
+		template<std::size_t N>
+		struct NameTable {
+			static constexpr std::size_t npos = N;
+			static constexpr std::size_t table_size = std::bit_ceil(N);
+			static constexpr std::size_t mask = table_size - 1;
+			static constexpr std::uint64_t max_displacement = 1 << 16;
+
+			std::array<std::string_view, N> names{};
+			std::array<std::int64_t, table_size> displacements{};
+			std::array<std::size_t, table_size> slots{};
+
+			constexpr NameTable(const std::array<std::string_view, N>& names) : names(names) {
+				slots.fill(npos);
+
+				std::array<std::uint64_t, N> hashes{};
+				std::vector<std::vector<std::size_t>> buckets(table_size);
+				for (std::size_t i = 0; i < N; ++i) {
+					hashes[i] = hash_name(names[i]);
+					auto& bucket = buckets[mix_hash(hashes[i], 0) & mask];
+					// equal names always share a bucket
+					for (auto j : bucket) {
+						if (names[i] == names[j]) {
+							throw std::logic_error("Duplicate field name");
+						}
+					}
+					bucket.push_back(i);
+				}
+
+				// place the largest buckets first, while the table is still empty
+				std::array<std::size_t, table_size> order{};
+				for (std::size_t b = 0; b < table_size; ++b) {
+					order[b] = b;
+				}
+				std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+					return buckets[a].size() > buckets[b].size();
+				});
+
+				std::size_t free_slot = 0;
+				std::vector<std::size_t> placed;
+				for (auto b : order) {
+					const auto& bucket = buckets[b];
+					if (bucket.empty()) {
+						break;
+					}
+
+					if (bucket.size() == 1) {
+						while (slots[free_slot] != npos) {
+							++free_slot;
+						}
+						slots[free_slot] = bucket[0];
+						displacements[b] = -static_cast<std::int64_t>(free_slot) - 1;
+						continue;
+					}
+
+					for (std::uint64_t d = 1;; ++d) {
+						if (d > max_displacement) {
+							throw std::logic_error("Could not build field name table");
+						}
+						placed.clear();
+						for (auto i : bucket) {
+							auto slot = mix_hash(hashes[i], d) & mask;
+							if (
+								slots[slot] != npos
+								|| std::find(placed.begin(), placed.end(), slot) != placed.end()
+							) {
+								break;
+							}
+							placed.push_back(slot);
+						}
+						if (placed.size() == bucket.size()) {
+							for (std::size_t k = 0; k < placed.size(); ++k) {
+								slots[placed[k]] = bucket[k];
+							}
+							displacements[b] = static_cast<std::int64_t>(d);
+							break;
+						}
+					}
+				}
+			}
+
+			constexpr std::size_t find(std::string_view name) const {
+				if constexpr (N == 0) {
+					return npos;
+				}
+				else {
+					auto h = hash_name(name);
+					auto d = displacements[mix_hash(h, 0) & mask];
+					auto slot = d < 0
+						? static_cast<std::size_t>(-d - 1)
+						: static_cast<std::size_t>(mix_hash(h, d) & mask);
+					auto i = slots[slot];
+					return i != npos && names[i] == name ? i : npos;
+				}
+			}
+		};
+
+		template<typename T>
+		inline constexpr NameTable<field_names<T>.size()> name_table{field_names<T>};
+
+		template<std::size_t I, typename T>
+		constexpr auto& field_at(T& s) {
+			auto& [...x] = s;
+			return x...[field_members<std::remove_const_t<T>>[I]];
+		}
+
+		// appends V to the list unless it's already there
+		template<typename... Ts, typename V>
+		constexpr auto operator +(TypeList<Ts...>, std::type_identity<V>) {
+			if constexpr ((std::same_as<Ts, V> || ...)) {
+				return TypeList<Ts...>{};
+			}
+			else {
+				return TypeList<Ts..., V>{};
+			}
+		}
+
+		template<typename T, std::size_t... I>
+		constexpr auto field_value_types(std::index_sequence<I...>) {
+			return (TypeList<>{} + ... + std::type_identity<field_value_at_t<T, I>>{});
+		}
+
+		// the distinct value types of T's fields, usually far fewer than the fields
+		template<typename T>
+		using field_value_types_t = decltype(
+			field_value_types<T>(std::make_index_sequence<field_members<T>.size()>{})
+		);
+
+		// for each field, the index of its value type in field_value_types_t
+		template<typename T>
+		inline constexpr auto field_value_type_indices = []<std::size_t... I>(std::index_sequence<I...>) {
+			using types_t = field_value_types_t<T>;
+			auto index_of = []<typename V, std::size_t... D>(std::type_identity<V>, std::index_sequence<D...>) {
+				return ((std::same_as<V, typename types_t::template at<D>> ? D : 0) + ... + 0);
+			};
+			return std::array<std::size_t, sizeof...(I)>{
+				index_of(std::type_identity<field_value_at_t<T, I>>{}, std::make_index_sequence<types_t::size>{})...
+			};
+		}(std::make_index_sequence<field_members<T>.size()>{});
+
+		// for each field, a function from the struct to its Field base
+		template<typename T>
+		inline constexpr auto field_getters = []<std::size_t... I>(std::index_sequence<I...>) {
+			return std::array<void* (*)(void*), sizeof...(I)>{
+				[](void* s) -> void* {
+					Field<field_value_at_t<T, I>>& field = field_at<I>(*static_cast<T*>(s));
+					return &field;
+				}...
+			};
+		}(std::make_index_sequence<field_members<T>.size()>{});
+
+		// Calls f with the i-th field as a Field<V>&, returning whether f handled it,
+		// or false if there is no such field. The per-field work happens once per
+		// struct type in the tables above, so a call site only instantiates f and
+		// this dispatch once per distinct value type, however wide the struct.
+		constexpr bool visit_field_at(auto& s, std::size_t i, auto&& f) {
+			using struct_t = std::remove_cvref_t<decltype(s)>;
+			using types_t = field_value_types_t<struct_t>;
+			if (i >= field_members<struct_t>.size()) {
+				return false;
+			}
+			void* field = field_getters<struct_t>[i](const_cast<struct_t*>(&s));
+			auto type = field_value_type_indices<struct_t>[i];
+			return [&]<std::size_t... D>(std::index_sequence<D...>) {
+				return (... || (D == type && [&] {
+					using field_t = Field<typename types_t::template at<D>>;
+					using ref_t = std::conditional_t<
+						std::is_const_v<std::remove_reference_t<decltype(s)>>,
+						const field_t&,
+						field_t&
+					>;
+					return static_cast<bool>(f(static_cast<ref_t>(*static_cast<field_t*>(field))));
+				}()));
+			}(std::make_index_sequence<types_t::size>{});
+		}
+
+		constexpr bool visit_field_with_name(auto& s, std::string_view name, auto&& f) {
+			using struct_t = std::remove_cvref_t<decltype(s)>;
+			return visit_field_at(s, name_table<struct_t>.find(name), f);
+		}
+
+		// Calls f with the field at a dotted path, returning false if there is
+		// none. Each struct's name table acts as a trie node whose children are
+		// the tables of its struct fields, so each segment costs one hash lookup
+		// and one table dispatch, with no string compares beyond the final one.
+		constexpr bool visit_field_path(auto& s, std::string_view path, auto&& f) {
+			auto dot = path.find('.');
+			if (dot == path.npos) {
+				return visit_field_with_name(s, path, f);
+			}
+			return visit_field_with_name(s, path.substr(0, dot), [&](auto& field) {
+				if constexpr (Reflectable<typename std::remove_cvref_t<decltype(field)>::type>) {
+					return visit_field_path(field.value, path.substr(dot + 1), f);
+				}
+				else {
+					return false;
+				}
+			});
+		}
+
+#ifdef KSER_INSTRUMENT
+		template<typename T>
+		TypeCounters& type_counters() {
+			if constexpr (Reflectable<T>) {
+				static TypeCounters counters(type_name<T>(), field_names<T>);
+				return counters;
+			}
+			else {
+				static TypeCounters counters(type_name<T>(), {});
+				return counters;
+			}
+		}
+#endif
+
+		// Records one call of op with a T, timed from construction to
+		// destruction, in T's counters. Does nothing unless KSER_INSTRUMENT is defined.
+		template<typename T>
+		class InstrumentScope {
+		public:
+			constexpr explicit InstrumentScope([[maybe_unused]] Operation op) {
+#ifdef KSER_INSTRUMENT
+				if !consteval {
+					this->op = op;
+					start = std::chrono::steady_clock::now();
+				}
+#endif
+			}
+
+			InstrumentScope(const InstrumentScope&) = delete;
+			InstrumentScope& operator =(const InstrumentScope&) = delete;
+
+			constexpr void add_bytes([[maybe_unused]] std::size_t n) {
+#ifdef KSER_INSTRUMENT
+				bytes += n;
+#endif
+			}
+
+			constexpr ~InstrumentScope() {
+#ifdef KSER_INSTRUMENT
+				if !consteval {
+					record_call(type_counters<T>(), op, std::chrono::steady_clock::now() - start, bytes);
+				}
+#endif
+			}
+
+#ifdef KSER_INSTRUMENT
+		private:
+			Operation op{};
+			std::chrono::steady_clock::time_point start{};
+			std::size_t bytes = 0;
+#endif
+		};
+
+		// counts one use of the I-th field of T by op
+		template<typename T>
+		constexpr void instrument_field(
+			[[maybe_unused]] Operation op,
+			[[maybe_unused]] std::size_t field,
+			[[maybe_unused]] std::size_t bytes = 0
+		) {
+#ifdef KSER_INSTRUMENT
+			if !consteval {
+				record_field(type_counters<T>(), op, field, bytes);
+			}
+#endif
+		}
+
+		// the field index of the member of type TField
+		template<typename T, typename TField>
+		inline constexpr std::size_t field_index_of = name_table<T>.find(TField::field_name());
+	}
+
+	// Field indices count NamedFields only, in declaration order.
+
+	template<typename T>
+		requires Reflectable<T>
+	inline constexpr std::size_t field_count = detail::field_members<T>.size();
+
+	template<typename T, StaticString Name>
+		requires Reflectable<T>
+			&& (detail::name_table<T>.find(Name.string_view()) != detail::name_table<T>.npos)
+	inline constexpr std::size_t field_index = detail::name_table<T>.find(Name.string_view());
+
+	template<typename T, std::size_t I>
+		requires Reflectable<T> && (I < field_count<T>)
+	using field_type_t = detail::field_value_at_t<T, I>;
+
+	template<typename T, std::size_t I>
+		requires Reflectable<T> && (I < field_count<T>)
+	inline constexpr std::string_view field_name = detail::field_names<T>[I];
+
+	// the value of the I-th field
+	template<std::size_t I, typename T>
+		requires Reflectable<std::remove_const_t<T>> && (I < field_count<std::remove_const_t<T>>)
+	constexpr auto& get(T& s) {
+		return detail::field_at<I>(s).value;
+	}
+
+	// Overloads taking the name as a template argument are resolved at compile
+	// time, so get_value<"age">(s) is just s.age.value, and an unknown name
+	// doesn't satisfy their constraints.
+
+	template<StaticString Name, typename T>
+		requires Reflectable<std::remove_const_t<T>>
+			&& requires { field_index<std::remove_const_t<T>, Name>; }
+	constexpr auto& get_field(T& s) {
+		return detail::field_at<field_index<std::remove_const_t<T>, Name>>(s);
+	}
+
+	template<StaticString Name, typename T>
+		requires Reflectable<std::remove_const_t<T>>
+			&& requires { field_index<std::remove_const_t<T>, Name>; }
+	constexpr auto& get_value(T& s) {
+		return get_field<Name>(s).value;
+	}
+
+	template<StaticString Name, typename T>
+		requires Reflectable<T> && requires { field_index<T, Name>; }
+	constexpr void set_value(T& s, auto&& value) {
+		get_field<Name>(s).value = std::forward<decltype(value)>(value);
+	}
+
+	// true or false rather than a compile error, for generic code
+	template<StaticString Name, typename T>
+		requires Reflectable<std::remove_const_t<T>>
+	constexpr bool has_field(T&) {
+		using struct_t = std::remove_const_t<T>;
+		return detail::name_table<struct_t>.find(Name.string_view()) != detail::name_table<struct_t>.npos;
+	}
+
+	namespace detail {
+		// whether Path, from its character Begin on, names a field of T,
+		// then a field of that field's struct, and so on
+		template<typename T, StaticString Path, std::size_t Begin = 0>
+		constexpr bool path_resolves() {
+			if constexpr (!Reflectable<T>) {
+				return false;
+			}
+			else {
+				constexpr auto path = Path.string_view();
+				constexpr auto dot = path.find('.', Begin);
+				constexpr auto i = name_table<T>.find(path.substr(Begin, dot - Begin));
+				if constexpr (i == name_table<T>.npos) {
+					return false;
+				}
+				else if constexpr (dot == path.npos) {
+					return true;
+				}
+				else {
+					return path_resolves<field_value_at_t<T, i>, Path, dot + 1>();
+				}
+			}
+		}
+
+		template<StaticString Path, std::size_t Begin, typename T>
+		constexpr auto& value_at_path(T& s) {
+			constexpr auto path = Path.string_view();
+			constexpr auto dot = path.find('.', Begin);
+			constexpr auto i = name_table<std::remove_const_t<T>>.find(path.substr(Begin, dot - Begin));
+			auto& value = field_at<i>(s).value;
+			if constexpr (dot == path.npos) {
+				return value;
+			}
+			else {
+				return value_at_path<Path, dot + 1>(value);
+			}
+		}
+	}
+
+	// Dotted paths through nested structs, such as "physics.velocity.x", are
+	// resolved segment by segment at compile time, so get_value_path<"a.b">(s)
+	// is just s.a.value.b.value, and a path that doesn't resolve doesn't compile.
+
+	template<StaticString Path, typename T>
+		requires Reflectable<std::remove_const_t<T>>
+			&& (detail::path_resolves<std::remove_const_t<T>, Path>())
+	constexpr auto& get_value_path(T& s) {
+		return detail::value_at_path<Path, 0>(s);
+	}
+
+	template<StaticString Path, typename T>
+		requires Reflectable<T> && (detail::path_resolves<T, Path>())
+	constexpr void set_value_path(T& s, auto&& value) {
+		get_value_path<Path>(s) = std::forward<decltype(value)>(value);
+	}
+
 	template<typename T>
 	constexpr Field<T>*
 	try_get_ptr_field_with_name(auto& s, std::string_view name) {
-		auto& [...x] = s;
 		Field<T>* out = nullptr;
-		(... || ([&] {
-			if constexpr (std::derived_from<decltype(x), Field<T>>) {
-				if (name == x.field_name()) {
-					out = &x;
-					return true;
-				}
+		detail::visit_field_with_name(s, name, [&](auto& x) {
+			if constexpr (std::derived_from<std::remove_reference_t<decltype(x)>, Field<T>>) {
+				out = &x;
 			}
-			return false;
-		})());
+			return true;
+		});
 		return out;
 	}
 
@@ -86,75 +606,76 @@ namespace kser {
 	}
 
 	constexpr bool has_field(auto& s, std::string_view name) {
-		auto [...x] = s;
-		return (... || ([&] {
-			if constexpr (IsField<decltype(x)>) {
-				if (name == x.field_name()) {
-					return true;
-				}
-			}
-			return false;
-		})());
+		using struct_t = std::remove_cvref_t<decltype(s)>;
+		return detail::name_table<struct_t>.find(name) != detail::name_table<struct_t>.npos;
 	}
 
 	template<typename T>
 	constexpr std::optional<T> try_get_value(auto& s, std::string_view name) {
-		auto& [...x] = s;
 		std::optional<T> out;
-		(... || ([&] {
+		detail::visit_field_with_name(s, name, [&](auto& x) {
+			if constexpr (std::assignable_from<decltype((out)), decltype(x.value)>) {
+				out = x.value;
+			}
+			return true;
+		});
+		return out;
+	}
+
+	namespace detail {
+		[[noreturn]] inline void throw_error(const Error& error) {
+			if (error.code == ErrorCode::TypeMismatch) {
+				throw TypeMismatch(error.name);
+			}
+			throw FieldNotFound(error.name);
+		}
+
+		// the value of field x as a T, for get_value and get_value_path
+		template<typename T, bool Strict>
+		constexpr std::expected<T, Error> field_value_as(auto& x, std::string_view name) {
 			if constexpr (
-				IsField<std::decay_t<decltype(x)>>
+				Strict
+					? std::same_as<T, std::decay_t<decltype(x.value)>>
+					: std::assignable_from<T&, decltype(x.value)>
 			) {
-				if constexpr (std::assignable_from<decltype((out)), decltype(x.value)>) {
-					if (name == x.field_name()) {
-						out = x.value;
-						return true;
-					}
-				}
+				std::expected<T, Error> out;
+				*out = x.value;
+				return out;
 			}
-			return false;
-		})());
+			else {
+				return std::unexpected(Error{ErrorCode::TypeMismatch, name});
+			}
+		}
+	}
+
+	// The *_expected accessors return a std::expected with an Error instead of
+	// throwing FieldNotFound or TypeMismatch, for lookups that often miss.
+
+	template<typename T, bool Strict = false>
+		requires std::default_initializable<T>
+	constexpr std::expected<T, Error> get_value_expected(auto& s, std::string_view name) {
+		std::expected<T, Error> out = std::unexpected(Error{ErrorCode::FieldNotFound, name});
+		detail::visit_field_with_name(s, name, [&](auto& x) {
+			out = detail::field_value_as<T, Strict>(x, name);
+			return true;
+		});
 		return out;
 	}
 
+	template<typename T>
+		requires std::default_initializable<T>
+	constexpr std::expected<T, Error> get_value_strict_expected(auto& s, std::string_view name) {
+		return get_value_expected<T, true>(s, name);
+	}
+
 	template<typename T, bool Strict = false>
 		requires std::default_initializable<T>
 	constexpr T get_value(auto& s, std::string_view name) {
-		auto& [...x] = s;
-		T out;
-		auto set = (... || ([&] -> bool {
-			if constexpr (
-				IsField<std::decay_t<decltype(x)>>
-			) {
-				if constexpr (Strict && std::same_as<T, std::decay_t<decltype(x.value)>>) {
-					if (name == x.field_name()) {
-						out = x.value;
-						return true;
-					}
-				}
-				else if constexpr (Strict) {
-					if (name == x.field_name()) {
-						throw TypeMismatch(name);
-					}
-				}
-				else if constexpr (std::assignable_from<decltype((out)), decltype(x.value)>) {
-					if (name == x.field_name()) {
-						out = x.value;
-						return true;
-					}
-				}
-				else {
-					if (name == x.field_name()) {
-						throw TypeMismatch(name);
-					}
-				}
-			}
-			return false;
-		})());
-		if (!set) {
-			throw FieldNotFound(name);
+		auto out = get_value_expected<T, Strict>(s, name);
+		if (!out) {
+			detail::throw_error(out.error());
 		}
-		return out;
+		return std::move(*out);
 	}
 
 	template<typename T>
@@ -163,6 +684,186 @@ namespace kser {
 		return get_value<T, true>(s, name);
 	}
 
+	// TypeMismatch if the field isn't a Field<T>
+	template<typename T>
+	constexpr std::expected<std::reference_wrapper<Field<T>>, Error>
+	get_field_with_name_expected(auto& s, std::string_view name) {
+		std::expected<std::reference_wrapper<Field<T>>, Error> out =
+			std::unexpected(Error{ErrorCode::FieldNotFound, name});
+		detail::visit_field_with_name(s, name, [&](auto& x) {
+			if constexpr (std::derived_from<std::remove_reference_t<decltype(x)>, Field<T>>) {
+				out = std::ref(x);
+			}
+			else {
+				out = std::unexpected(Error{ErrorCode::TypeMismatch, name});
+			}
+			return true;
+		});
+		return out;
+	}
+
+	// TypeMismatch if value can't be assigned to the field
+	constexpr std::expected<void, Error> set_value_expected(auto& s, std::string_view name, const auto& value) {
+		std::expected<void, Error> out = std::unexpected(Error{ErrorCode::FieldNotFound, name});
+		detail::visit_field_with_name(s, name, [&](auto& x) {
+			if constexpr (std::assignable_from<decltype((x.value)), decltype(value)>) {
+				x.value = value;
+				out = {};
+			}
+			else {
+				out = std::unexpected(Error{ErrorCode::TypeMismatch, name});
+			}
+			return true;
+		});
+		return out;
+	}
+
+	// The same as get_value, try_get_value and set_value, for runtime dotted
+	// paths such as "physics.velocity.x" through nested NamedField structs.
+	// Errors name the whole path.
+
+	template<typename T, bool Strict = false>
+		requires std::default_initializable<T>
+	constexpr std::expected<T, Error> get_value_path_expected(auto& s, std::string_view path) {
+		std::expected<T, Error> out = std::unexpected(Error{ErrorCode::FieldNotFound, path});
+		detail::visit_field_path(s, path, [&](auto& x) {
+			out = detail::field_value_as<T, Strict>(x, path);
+			return true;
+		});
+		return out;
+	}
+
+	template<typename T, bool Strict = false>
+		requires std::default_initializable<T>
+	constexpr T get_value_path(auto& s, std::string_view path) {
+		auto out = get_value_path_expected<T, Strict>(s, path);
+		if (!out) {
+			detail::throw_error(out.error());
+		}
+		return std::move(*out);
+	}
+
+	template<typename T>
+	constexpr std::optional<T> try_get_value_path(auto& s, std::string_view path) {
+		std::optional<T> out;
+		detail::visit_field_path(s, path, [&](auto& x) {
+			if constexpr (std::assignable_from<decltype((out)), decltype(x.value)>) {
+				out = x.value;
+			}
+			return true;
+		});
+		return out;
+	}
+
+	// Returns false if there's no field at path, and throws TypeMismatch if
+	// value can't be assigned to it.
+	constexpr bool set_value_path(auto& s, std::string_view path, const auto& value) {
+		return detail::visit_field_path(s, path, [&](auto& x) -> bool {
+			if constexpr (std::assignable_from<decltype((x.value)), decltype(value)>) {
+				x.value = value;
+				return true;
+			}
+			else {
+				throw TypeMismatch(path);
+			}
+		});
+	}
+
+	// A map from each of T's field names to a V, stored inline in field order,
+	// for get_value_map and get_field_map without any allocation. Every key
+	// is always present, and lookups go through T's name table.
+	template<typename T, typename V>
+		requires Reflectable<T> && std::default_initializable<V>
+	class StaticValueMap {
+	public:
+		using key_type = std::string_view;
+		using mapped_type = V;
+		using value_type = std::pair<const std::string_view, V>;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		constexpr StaticValueMap()
+			: entries([]<std::size_t... I>(std::index_sequence<I...>) {
+				return std::array<value_type, sizeof...(I)>{
+					value_type{detail::field_names<T>[I], V{}}...
+				};
+			}(std::make_index_sequence<detail::field_members<T>.size()>{})) {}
+
+		constexpr StaticValueMap(const StaticValueMap&) = default;
+		constexpr StaticValueMap(StaticValueMap&&) = default;
+
+		// the keys are always the same, so only the values are assigned
+		constexpr StaticValueMap& operator =(const StaticValueMap& other) {
+			for (std::size_t i = 0; i < entries.size(); ++i) {
+				entries[i].second = other.entries[i].second;
+			}
+			return *this;
+		}
+
+		constexpr StaticValueMap& operator =(StaticValueMap&& other) {
+			for (std::size_t i = 0; i < entries.size(); ++i) {
+				entries[i].second = std::move(other.entries[i].second);
+			}
+			return *this;
+		}
+
+		// throws FieldNotFound if name isn't one of T's fields
+		constexpr V& operator [](std::string_view name) {
+			return at(name);
+		}
+
+		constexpr V& at(std::string_view name) {
+			auto it = find(name);
+			if (it == end()) {
+				throw FieldNotFound(name);
+			}
+			return it->second;
+		}
+
+		constexpr const V& at(std::string_view name) const {
+			auto it = find(name);
+			if (it == end()) {
+				throw FieldNotFound(name);
+			}
+			return it->second;
+		}
+
+		constexpr iterator find(std::string_view name) {
+			return entries.data() + detail::name_table<T>.find(name);
+		}
+
+		constexpr const_iterator find(std::string_view name) const {
+			return entries.data() + detail::name_table<T>.find(name);
+		}
+
+		constexpr bool contains(std::string_view name) const {
+			return find(name) != end();
+		}
+
+		constexpr iterator begin() {
+			return entries.data();
+		}
+
+		constexpr iterator end() {
+			return entries.data() + entries.size();
+		}
+
+		constexpr const_iterator begin() const {
+			return entries.data();
+		}
+
+		constexpr const_iterator end() const {
+			return entries.data() + entries.size();
+		}
+
+		constexpr std::size_t size() const {
+			return entries.size();
+		}
+
+	private:
+		std::array<value_type, detail::field_members<T>.size()> entries;
+	};
+
 	template<typename TMap>
 	constexpr void get_field_map(auto& s, TMap& out) {
 		auto& [...x] = s;
@@ -185,12 +886,18 @@ namespace kser {
 
 	template<typename TMap>
 	constexpr void get_value_map(auto& s, TMap& out) {
+		using struct_t = std::remove_cvref_t<decltype(s)>;
+		detail::InstrumentScope<struct_t> scope(Operation::GetValueMap);
 		auto& [...x] = s;
 		(([&] {
 			if constexpr (
 				IsField<std::decay_t<decltype(x)>>
 			) {
 				out[x.field_name()] = x.value;
+				detail::instrument_field<struct_t>(
+					Operation::GetValueMap,
+					detail::field_index_of<struct_t, std::decay_t<decltype(x)>>
+				);
 			}
 		})(), ...);
 	}
@@ -203,6 +910,88 @@ namespace kser {
 		return out;
 	}
 
+	namespace detail {
+		// Rebuilds the allocator-aware parts of member with resource, keeping
+		// their values, so default member initializers survive.
+		template<typename T>
+		void use_resource(T& member, std::pmr::memory_resource* resource) {
+			if constexpr (IsField<T>) {
+				use_resource(member.value, resource);
+			}
+			else if constexpr (std::uses_allocator_v<T, std::pmr::polymorphic_allocator<>>) {
+				// not assigned, since a pmr container keeps its old allocator when
+				// assigned to; the moved value is put back by move construction,
+				// which takes the new allocator along with it
+				auto rebuilt = std::make_obj_using_allocator<T>(
+					std::pmr::polymorphic_allocator<>(resource),
+					std::move(member)
+				);
+				std::destroy_at(&member);
+				std::construct_at(&member, std::move(rebuilt));
+			}
+			else if constexpr (Reflectable<T>) {
+				auto& [...x] = member;
+				(use_resource(x, resource), ...);
+			}
+		}
+	}
+
+	// Constructs a T whose allocator-aware members, such as std::pmr::string
+	// and std::pmr::vector fields, allocate from resource, as do those of
+	// nested structs. Members keep their default member initializers.
+	// Assigning to a pmr container keeps its allocator, so anything parsed or
+	// set into the result afterwards allocates from resource too, and a batch
+	// of records built on a std::pmr::monotonic_buffer_resource can be freed
+	// all at once.
+	template<typename T>
+		requires Reflectable<T>
+	T make_with_resource(std::pmr::memory_resource* resource) {
+		T out{};
+		detail::use_resource(out, resource);
+		return out;
+	}
+
+	namespace detail {
+		// Deserializers add elements through these, so structs in pmr containers
+		// use the container's resource like strings in them already do.
+		auto& emplace_back_element(auto& out) {
+			using value_t = std::ranges::range_value_t<decltype(out)>;
+			if constexpr (Reflectable<value_t> && requires { out.get_allocator().resource(); }) {
+				return out.emplace_back(make_with_resource<value_t>(out.get_allocator().resource()));
+			}
+			else {
+				return out.emplace_back();
+			}
+		}
+
+		template<typename TMap>
+		auto& try_emplace_mapped(TMap& out, typename TMap::key_type&& key) {
+			using mapped_t = typename TMap::mapped_type;
+			if constexpr (Reflectable<mapped_t> && requires { out.get_allocator().resource(); }) {
+				return out.try_emplace(
+					std::move(key),
+					make_with_resource<mapped_t>(out.get_allocator().resource())
+				).first->second;
+			}
+			else {
+				return out.try_emplace(std::move(key)).first->second;
+			}
+		}
+
+		// built with the map's allocator, so a std::pmr::string key isn't
+		// allocated once on the heap and again when it is moved into the map
+		template<typename TMap>
+		typename TMap::key_type make_map_key(const TMap& out, std::string_view key) {
+			using key_t = typename TMap::key_type;
+			if constexpr (requires { out.get_allocator(); }) {
+				return std::make_obj_using_allocator<key_t>(out.get_allocator(), key);
+			}
+			else {
+				return key_t(key);
+			}
+		}
+	}
+
 	template<typename T>
 	struct StaticCastCaster {
 		auto operator ()(auto& x) {
@@ -224,6 +1013,15 @@ namespace kser {
 		}
 	};
 
+	// hands the value over as is, so a std::string or std::pmr::string field
+	// is assigned in place instead of from a converted copy
+	template<typename T>
+	struct AssignCaster {
+		auto& operator ()(auto& x) {
+			return x;
+		}
+	};
+
 	template<typename T>
 	struct DefaultCaster{};
 
@@ -234,45 +1032,152 @@ namespace kser {
 			std::same_as<TVal, std::any>,
 			AnyCastCaster<TOut>,
 			std::conditional_t<
-				requires(TVal x) { { std::get<TOut>(x) } -> std::convertible_to<TOut>; },
-				GetCaster<TOut>,
-				StaticCastCaster<TOut>
+				// not std::assignable_from, which also wants a common reference, and
+				// std::pmr::string& and const std::string& have none
+				requires(TOut& out, const TVal& value) { out = value; },
+				AssignCaster<TOut>,
+				std::conditional_t<
+					requires(TVal x) { { std::get<TOut>(x) } -> std::convertible_to<TOut>; },
+					GetCaster<TOut>,
+					StaticCastCaster<TOut>
+				>
 			>
 		>,
 		TCast<TOut>
 	>;
 
+	// Sets the fields named by the keys of in, returning how many were set.
+	// in is a map, or any range of key/value pairs such as a span of std::pair.
+	// Whichever of in and the struct's fields is smaller is walked, and keys
+	// are dispatched to fields through the name table.
 	template<template<typename> typename TCast = DefaultCaster>
 	constexpr int set_values(auto& s, const auto& in) {
-		auto& [...x] = s;
-		return (... + ([&] {
-			if constexpr (
-				IsField<std::decay_t<decltype(x)>>
-			) {
-				auto it = in.find(x.field_name());
-				if (it != in.end()) {
-					Caster<decltype(x.value), decltype(it->second), TCast> caster;
-					x.value = caster(it->second);
-					return 1;
-				}
+		using struct_t = std::remove_cvref_t<decltype(s)>;
+		constexpr auto count = detail::field_members<struct_t>.size();
+		detail::InstrumentScope<struct_t> scope(Operation::SetValues);
+
+		if constexpr (requires { in.find(std::string_view{}); std::ranges::size(in); }) {
+			if (std::ranges::size(in) >= count) {
+				auto& [...x] = s;
+				return (... + ([&] {
+					if constexpr (
+						IsField<std::decay_t<decltype(x)>>
+					) {
+						auto it = in.find(x.field_name());
+						if (it != in.end()) {
+							Caster<decltype(x.value), decltype(it->second), TCast> caster;
+							x.value = caster(it->second);
+							detail::instrument_field<struct_t>(
+								Operation::SetValues,
+								detail::field_index_of<struct_t, std::decay_t<decltype(x)>>
+							);
+							return 1;
+						}
+					}
+					return 0;
+				})());
 			}
-			return 0;
-		})());
+		}
+
+		int n = 0;
+		for (const auto& [key, value] : in) {
+			auto i = detail::name_table<struct_t>.find(key);
+			auto set = detail::visit_field_at(s, i, [&](auto& x) {
+				Caster<decltype(x.value), std::remove_cvref_t<decltype(value)>, TCast> caster;
+				x.value = caster(value);
+				return true;
+			});
+			if (set) {
+				detail::instrument_field<struct_t>(Operation::SetValues, i);
+				++n;
+			}
+		}
+		return n;
 	}
 
-	constexpr bool set_value(auto& s, std::string_view name, auto value) {
-		auto& [...x] = s;
-		return (... || ([&] {
-			if constexpr (
-				IsField<std::decay_t<decltype(x)>>
+	namespace detail {
+		// whether Caster can convert a TVal at all, which set_values assumes
+		template<typename TOut, typename TVal, template<typename> typename TCast>
+		concept CastableTo =
+			!std::same_as<Caster<TOut, TVal, TCast>, StaticCastCaster<TOut>>
+			|| requires(const TVal& value) { static_cast<TOut>(value); };
+
+		// whether Caster can convert value without throwing
+		template<typename TOut, template<typename> typename TCast>
+		constexpr bool castable(const auto& value) {
+			using value_t = std::remove_cvref_t<decltype(value)>;
+			using caster_t = Caster<TOut, value_t, TCast>;
+			if constexpr (std::same_as<caster_t, AnyCastCaster<TOut>>) {
+				return std::any_cast<std::decay_t<TOut>>(&value) != nullptr;
+			}
+			else if constexpr (
+				std::same_as<caster_t, GetCaster<TOut>>
+				&& requires { std::holds_alternative<TOut>(value); }
 			) {
-				if (name == x.field_name()) {
-					x.value = value;
-					return true;
+				return std::holds_alternative<TOut>(value);
+			}
+			else {
+				return true;
+			}
+		}
+	}
+
+	// Like set_values, but keys that aren't fields, and values the caster
+	// can't convert, are errors rather than skipped or thrown: each is passed
+	// to on_error as it is found, and the other keys are still set. Returns the
+	// number of fields set, or the first error. Custom casters that throw still
+	// throw. Unlike set_values, fields of types no value converts to are fine.
+	template<template<typename> typename TCast = DefaultCaster>
+	constexpr std::expected<int, Error> set_values_expected(auto& s, const auto& in, auto&& on_error) {
+		using struct_t = std::remove_cvref_t<decltype(s)>;
+		detail::InstrumentScope<struct_t> scope(Operation::SetValues);
+		std::optional<Error> first_error;
+		auto fail = [&](Error error) {
+			if (!first_error) {
+				first_error = error;
+			}
+			on_error(error);
+		};
+
+		int n = 0;
+		for (const auto& [key, value] : in) {
+			std::string_view name = key;
+			auto i = detail::name_table<struct_t>.find(name);
+			auto found = detail::visit_field_at(s, i, [&](auto& x) {
+				using out_t = decltype(x.value);
+				using value_t = std::remove_cvref_t<decltype(value)>;
+				if constexpr (detail::CastableTo<out_t, value_t, TCast>) {
+					if (detail::castable<out_t, TCast>(value)) {
+						Caster<out_t, value_t, TCast> caster;
+						x.value = caster(value);
+						detail::instrument_field<struct_t>(Operation::SetValues, i);
+						++n;
+						return true;
+					}
 				}
+				fail(Error{ErrorCode::TypeMismatch, name});
+				return true;
+			});
+			if (!found) {
+				fail(Error{ErrorCode::FieldNotFound, name});
 			}
-			return false;
-		})());
+		}
+		if (first_error) {
+			return std::unexpected(*first_error);
+		}
+		return n;
+	}
+
+	template<template<typename> typename TCast = DefaultCaster>
+	constexpr std::expected<int, Error> set_values_expected(auto& s, const auto& in) {
+		return set_values_expected<TCast>(s, in, [](const Error&) {});
+	}
+
+	constexpr bool set_value(auto& s, std::string_view name, auto value) {
+		return detail::visit_field_with_name(s, name, [&](auto& x) {
+			x.value = value;
+			return true;
+		});
 	}
 
 	constexpr void visit_fields(auto& s, auto& visitor) {
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <kser/binary.hpp>
+#include <kser/serialize.hpp>
+#include <cstddef> 		// byte
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace kser {
+	// Writes MessagePack (https://msgpack.org): structs and maps are maps with
+	// string keys, and every value uses its smallest encoding.
+	class MsgPackWriter {
+	public:
+		explicit MsgPackWriter(std::vector<std::byte>& out) : writer{out} {}
+
+		void null() {
+			writer.put(0xc0);
+		}
+
+		void boolean(bool value) {
+			writer.put(value ? 0xc3 : 0xc2);
+		}
+
+		template<typename V>
+			requires std::is_arithmetic_v<V>
+		void number(V value) {
+			if constexpr (std::floating_point<V>) {
+				if constexpr (sizeof(V) <= sizeof(float)) {
+					writer.put(0xca);
+					writer.write_big_endian(static_cast<float>(value));
+				}
+				else {
+					writer.put(0xcb);
+					writer.write_big_endian(static_cast<double>(value));
+				}
+			}
+			else if constexpr (std::is_signed_v<V>) {
+				if (value >= 0) {
+					write_unsigned(static_cast<std::uint64_t>(value));
+				}
+				else {
+					write_negative(static_cast<std::int64_t>(value));
+				}
+			}
+			else {
+				write_unsigned(static_cast<std::uint64_t>(value));
+			}
+		}
+
+		void string(std::string_view s) {
+			if (s.size() < 32) {
+				writer.put(static_cast<std::uint8_t>(0xa0 | s.size()));
+			}
+			else if (s.size() <= 0xff) {
+				writer.put(0xd9);
+				writer.put(static_cast<std::uint8_t>(s.size()));
+			}
+			else if (s.size() <= 0xffff) {
+				writer.put(0xda);
+				writer.write_big_endian(static_cast<std::uint16_t>(s.size()));
+			}
+			else {
+				writer.put(0xdb);
+				writer.write_big_endian(static_cast<std::uint32_t>(s.size()));
+			}
+			writer.write(s.data(), s.size());
+		}
+
+		void begin_array(std::size_t size) {
+			write_container(size, 0x90, 0xdc);
+		}
+
+		void end_array() {}
+
+		void begin_object(std::size_t size) {
+			write_container(size, 0x80, 0xde);
+		}
+
+		void key(std::string_view key) {
+			string(key);
+		}
+
+		void key(std::integral auto key) {
+			number(key);
+		}
+
+		void end_object() {}
+
+	private:
+		void write_unsigned(std::uint64_t value) {
+			if (value < 0x80) {
+				// positive fixint
+				writer.put(static_cast<std::uint8_t>(value));
+			}
+			else if (value <= 0xff) {
+				writer.put(0xcc);
+				writer.put(static_cast<std::uint8_t>(value));
+			}
+			else if (value <= 0xffff) {
+				writer.put(0xcd);
+				writer.write_big_endian(static_cast<std::uint16_t>(value));
+			}
+			else if (value <= 0xffffffff) {
+				writer.put(0xce);
+				writer.write_big_endian(static_cast<std::uint32_t>(value));
+			}
+			else {
+				writer.put(0xcf);
+				writer.write_big_endian(value);
+			}
+		}
+
+		void write_negative(std::int64_t value) {
+			if (value >= -32) {
+				// negative fixint
+				writer.put(static_cast<std::uint8_t>(value));
+			}
+			else if (value >= INT8_MIN) {
+				writer.put(0xd0);
+				writer.write_big_endian(static_cast<std::int8_t>(value));
+			}
+			else if (value >= INT16_MIN) {
+				writer.put(0xd1);
+				writer.write_big_endian(static_cast<std::int16_t>(value));
+			}
+			else if (value >= INT32_MIN) {
+				writer.put(0xd2);
+				writer.write_big_endian(static_cast<std::int32_t>(value));
+			}
+			else {
+				writer.put(0xd3);
+				writer.write_big_endian(value);
+			}
+		}
+
+		// fix is the fixarray or fixmap tag; the 32 bit tag follows the 16 bit one
+		void write_container(std::size_t size, std::uint8_t fix, std::uint8_t tag16) {
+			if (size < 16) {
+				writer.put(static_cast<std::uint8_t>(fix | size));
+			}
+			else if (size <= 0xffff) {
+				writer.put(tag16);
+				writer.write_big_endian(static_cast<std::uint16_t>(size));
+			}
+			else {
+				writer.put(static_cast<std::uint8_t>(tag16 + 1));
+				writer.write_big_endian(static_cast<std::uint32_t>(size));
+			}
+		}
+
+		detail::BinaryWriter writer;
+	};
+
+	// Appends value as MessagePack to out.
+	template<typename T>
+		requires JsonSerializable<T>
+	void serialize_msgpack(const T& value, std::vector<std::byte>& out) {
+		MsgPackWriter writer{out};
+		serialize(writer, value);
+	}
+
+	template<typename T>
+		requires JsonSerializable<T>
+	std::vector<std::byte> serialize_msgpack(const T& value) {
+		std::vector<std::byte> out;
+		serialize_msgpack(value, out);
+		return out;
+	}
+}
\ No newline at end of file
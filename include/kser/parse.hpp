@@ -0,0 +1,586 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <bit> 			// countr_zero
+#include <charconv> 	// from_chars
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KSER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace kser {
+	namespace detail {
+		constexpr bool is_json_space(char c) {
+			return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+		}
+
+		constexpr bool is_number_char(char c) {
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+
+		inline const char* skip_json_space(const char* p, const char* end) {
+			// separators are usually at most one space, so don't go wide for those
+			if (p == end || !is_json_space(*p)) {
+				return p;
+			}
+			++p;
+#ifdef KSER_SSE2
+			while (end - p >= 16) {
+				auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				auto space = _mm_or_si128(
+					_mm_or_si128(
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))
+					),
+					_mm_or_si128(
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))
+					)
+				);
+				auto mask = static_cast<unsigned>(_mm_movemask_epi8(space)) ^ 0xffffu;
+				if (mask) {
+					return p + std::countr_zero(mask);
+				}
+				p += 16;
+			}
+#endif
+			while (p != end && is_json_space(*p)) {
+				++p;
+			}
+			return p;
+		}
+
+		// finds the end of a run of plain string characters:
+		// the first quote, backslash or control character
+		inline const char* find_json_string_special(const char* p, const char* end) {
+#ifdef KSER_SSE2
+			while (end - p >= 16) {
+				auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				auto control_max = _mm_set1_epi8(0x1f);
+				auto special = _mm_or_si128(
+					_mm_or_si128(
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+						_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))
+					),
+					// unsigned c <= 0x1f
+					_mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max)
+				);
+				auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+				if (mask) {
+					return p + std::countr_zero(mask);
+				}
+				p += 16;
+			}
+#endif
+			while (
+				p != end
+				&& *p != '"'
+				&& *p != '\\'
+				&& static_cast<unsigned char>(*p) >= 0x20
+			) {
+				++p;
+			}
+			return p;
+		}
+
+		// unknown values nested deeper than this are rejected instead of
+		// skipped, since skipping recurses once per level
+		inline constexpr std::size_t max_skip_depth = 512;
+
+		// character views such as std::string_view, which would have nothing to
+		// point into once parsing returns, so their values are skipped
+		template<typename T>
+		concept IsStringView = std::convertible_to<const T&, std::string_view> && !IsString<T>;
+
+		// types a parsed string is assigned to whole, such as std::any, but not
+		// string views, which would point into the temporary string
+		template<typename T>
+		concept AssignableFromString =
+			std::assignable_from<T&, std::string>
+			&& !std::convertible_to<const T&, std::string_view>;
+
+		struct JsonParser {
+			const char* begin;
+			const char* p;
+			const char* end;
+			// keys are views into the input unless they contain escapes
+			std::string key_scratch;
+			// offset of begin in the whole input, for errors
+			std::size_t base = 0;
+
+			explicit JsonParser(std::string_view json)
+				: begin(json.data()), p(json.data()), end(json.data() + json.size()) {}
+
+			[[noreturn]] void fail(std::string_view what) const {
+				throw ParseError(what, base + static_cast<std::size_t>(p - begin));
+			}
+
+			void skip_space() {
+				p = skip_json_space(p, end);
+			}
+
+			bool consume(char c) {
+				if (p != end && *p == c) {
+					++p;
+					return true;
+				}
+				return false;
+			}
+
+			void expect(char c) {
+				if (!consume(c)) {
+					switch (c) {
+						case '{': fail("Expected '{'");
+						case '[': fail("Expected '['");
+						case '}': fail("Expected ',' or '}'");
+						case ']': fail("Expected ',' or ']'");
+						case ':': fail("Expected ':'");
+						case '"': fail("Expected string");
+						default: fail("Unexpected character");
+					}
+				}
+			}
+
+			bool consume_literal(std::string_view literal) {
+				if (static_cast<std::size_t>(end - p) >= literal.size()
+					&& std::memcmp(p, literal.data(), literal.size()) == 0
+				) {
+					p += literal.size();
+					return true;
+				}
+				return false;
+			}
+
+			unsigned parse_hex4() {
+				if (end - p < 4) {
+					fail("Invalid unicode escape");
+				}
+				unsigned out = 0;
+				for (int i = 0; i < 4; ++i, ++p) {
+					out <<= 4;
+					if (*p >= '0' && *p <= '9') out |= *p - '0';
+					else if (*p >= 'a' && *p <= 'f') out |= *p - 'a' + 10;
+					else if (*p >= 'A' && *p <= 'F') out |= *p - 'A' + 10;
+					else fail("Invalid unicode escape");
+				}
+				return out;
+			}
+
+			void append_utf8(auto& out, unsigned cp) {
+				if (cp < 0x80) {
+					out.push_back(static_cast<char>(cp));
+				}
+				else if (cp < 0x800) {
+					out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+					out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+				}
+				else if (cp < 0x10000) {
+					out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+					out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+					out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+				}
+				else {
+					out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+					out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+					out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+					out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+				}
+			}
+
+			// p is just past the backslash
+			void parse_escape(auto& out) {
+				if (p == end) {
+					fail("Unterminated string");
+				}
+				switch (*p++) {
+					case '"': out.push_back('"'); break;
+					case '\\': out.push_back('\\'); break;
+					case '/': out.push_back('/'); break;
+					case 'b': out.push_back('\b'); break;
+					case 'f': out.push_back('\f'); break;
+					case 'n': out.push_back('\n'); break;
+					case 'r': out.push_back('\r'); break;
+					case 't': out.push_back('\t'); break;
+					case 'u': {
+						auto cp = parse_hex4();
+						if (cp >= 0xd800 && cp < 0xdc00) {
+							if (!consume_literal("\\u")) {
+								fail("Invalid unicode escape");
+							}
+							auto low = parse_hex4();
+							if (low < 0xdc00 || low >= 0xe000) {
+								fail("Invalid unicode escape");
+							}
+							cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+						}
+						else if (cp >= 0xdc00 && cp < 0xe000) {
+							fail("Invalid unicode escape");
+						}
+						append_utf8(out, cp);
+						break;
+					}
+					default:
+						--p;
+						fail("Invalid escape");
+				}
+			}
+
+			// p is just past the opening quote
+			void parse_string_rest(auto& out) {
+				while (true) {
+					auto run_end = find_json_string_special(p, end);
+					out.append(p, run_end);
+					p = run_end;
+					if (p == end) {
+						fail("Unterminated string");
+					}
+					if (*p == '"') {
+						++p;
+						return;
+					}
+					if (*p != '\\') {
+						fail("Unescaped control character in string");
+					}
+					++p;
+					parse_escape(out);
+				}
+			}
+
+			void parse_string(auto& out) {
+				expect('"');
+				parse_string_rest(out);
+			}
+
+			std::string_view parse_key() {
+				expect('"');
+				auto run_end = find_json_string_special(p, end);
+				if (run_end != end && *run_end == '"') {
+					std::string_view key{p, run_end};
+					p = run_end + 1;
+					return key;
+				}
+				key_scratch.clear();
+				parse_string_rest(key_scratch);
+				return key_scratch;
+			}
+
+			void skip_string() {
+				expect('"');
+				while (true) {
+					p = find_json_string_special(p, end);
+					if (p == end) {
+						fail("Unterminated string");
+					}
+					if (*p == '"') {
+						++p;
+						return;
+					}
+					if (*p != '\\') {
+						fail("Unescaped control character in string");
+					}
+					if (end - p < 2) {
+						p = end;
+						fail("Unterminated string");
+					}
+					p += 2;
+				}
+			}
+
+			void skip_value(std::size_t depth = 0) {
+				if (p == end) {
+					fail("Unexpected end of input");
+				}
+				if ((*p == '{' || *p == '[') && depth == max_skip_depth) {
+					fail("Nesting too deep");
+				}
+				switch (*p) {
+					case '"':
+						skip_string();
+						return;
+					case '{':
+						++p;
+						skip_space();
+						if (consume('}')) {
+							return;
+						}
+						while (true) {
+							skip_space();
+							skip_string();
+							skip_space();
+							expect(':');
+							skip_space();
+							skip_value(depth + 1);
+							skip_space();
+							if (!consume(',')) {
+								expect('}');
+								return;
+							}
+						}
+					case '[':
+						++p;
+						skip_space();
+						if (consume(']')) {
+							return;
+						}
+						while (true) {
+							skip_space();
+							skip_value(depth + 1);
+							skip_space();
+							if (!consume(',')) {
+								expect(']');
+								return;
+							}
+						}
+					default: {
+						if (consume_literal("true") || consume_literal("false") || consume_literal("null")) {
+							return;
+						}
+						auto start = p;
+						while (p != end && is_number_char(*p)) {
+							++p;
+						}
+						if (p == start) {
+							fail("Unexpected character");
+						}
+					}
+				}
+			}
+
+			template<typename T>
+			void parse_value(T& out) {
+				if (p == end) {
+					fail("Unexpected end of input");
+				}
+				// null empties optionals and leaves anything else untouched
+				if (*p == 'n' && consume_literal("null")) {
+					if constexpr (IsOptional<T>) {
+						out.reset();
+					}
+					return;
+				}
+
+				if constexpr (std::same_as<T, bool>) {
+					if (consume_literal("true")) {
+						out = true;
+					}
+					else if (consume_literal("false")) {
+						out = false;
+					}
+					else {
+						fail("Expected boolean");
+					}
+				}
+				else if constexpr (std::integral<T> || std::floating_point<T>) {
+					auto result = std::from_chars(p, end, out);
+					if (result.ec != std::errc{}) {
+						fail("Expected number");
+					}
+					p = result.ptr;
+				}
+				else if constexpr (
+					IsString<T>
+					&& requires(T& s, const char* c) { s.clear(); s.push_back(*c); s.append(c, c); }
+				) {
+					// in place, so std::pmr::strings keep their allocator
+					out.clear();
+					parse_string(out);
+				}
+				else if constexpr (IsString<T>) {
+					std::string s;
+					parse_string(s);
+					out.assign(s.data(), s.size());
+				}
+				else if constexpr (IsStringView<T>) {
+					skip_value();
+				}
+				else if constexpr (IsOptional<T>) {
+					parse_value(out ? *out : out.emplace());
+				}
+				else if constexpr (IsMap<T>) {
+					parse_map(out);
+				}
+				else if constexpr (IsSequence<T>) {
+					parse_array(out);
+				}
+				else if constexpr (AssignableFromString<T>) {
+					std::string s;
+					parse_string(s);
+					out = std::move(s);
+				}
+				else if constexpr (Reflectable<T>) {
+					parse_object(out);
+				}
+				else {
+					skip_value();
+				}
+			}
+
+			template<typename T>
+			void parse_object(T& out) {
+				expect('{');
+				skip_space();
+				if (consume('}')) {
+					return;
+				}
+				while (true) {
+					skip_space();
+					auto key = parse_key();
+					skip_space();
+					expect(':');
+					skip_space();
+					auto i = name_table<T>.find(key);
+					auto start = p;
+					auto found = visit_field_at(out, i, [this](auto& field) {
+						parse_value(field.value);
+						return true;
+					});
+					if (!found) {
+						skip_value();
+					}
+					else if constexpr (instrumentation_enabled) {
+						instrument_field<T>(Operation::ParseJson, i, static_cast<std::size_t>(p - start));
+					}
+					skip_space();
+					if (!consume(',')) {
+						expect('}');
+						return;
+					}
+				}
+			}
+
+			// replaces the contents of out
+			template<typename T>
+			void parse_map(T& out) {
+				using key_t = typename T::key_type;
+				expect('{');
+				out.clear();
+				skip_space();
+				if (consume('}')) {
+					return;
+				}
+				while (true) {
+					skip_space();
+					auto key = parse_key();
+					skip_space();
+					expect(':');
+					skip_space();
+					if constexpr (std::integral<key_t>) {
+						key_t k{};
+						auto result = std::from_chars(key.data(), key.data() + key.size(), k);
+						if (result.ec != std::errc{} || result.ptr != key.data() + key.size()) {
+							fail("Expected integer key");
+						}
+						parse_value(try_emplace_mapped(out, std::move(k)));
+					}
+					else {
+						parse_value(try_emplace_mapped(out, make_map_key(out, key)));
+					}
+					skip_space();
+					if (!consume(',')) {
+						expect('}');
+						return;
+					}
+				}
+			}
+
+			// p is at the start of an element
+			template<typename T>
+			void parse_element(T& out, std::size_t i) {
+				using value_t = std::ranges::range_value_t<T>;
+				if constexpr (requires { std::tuple_size<T>::value; }) {
+					// fixed size, like std::array
+					if (i >= std::tuple_size_v<T>) {
+						fail("Too many elements");
+					}
+					parse_value(out[i]);
+				}
+				else if constexpr (requires { { out.emplace_back() } -> std::same_as<value_t&>; }) {
+					parse_value(emplace_back_element(out));
+				}
+				else if constexpr (requires(value_t v) { out.push_back(std::move(v)); }) {
+					// such as std::vector<bool>
+					value_t value{};
+					parse_value(value);
+					out.push_back(std::move(value));
+				}
+				else if constexpr (requires(value_t v) { out.insert(std::move(v)); }) {
+					value_t value{};
+					parse_value(value);
+					out.insert(std::move(value));
+				}
+				else {
+					skip_value();
+				}
+			}
+
+			// replaces the contents of out; fixed size arrays keep any elements past the end of the input
+			template<typename T>
+			void parse_array(T& out) {
+				expect('[');
+				if constexpr (requires { out.clear(); }) {
+					out.clear();
+				}
+				skip_space();
+				if (consume(']')) {
+					return;
+				}
+				for (std::size_t i = 0; ; ++i) {
+					skip_space();
+					parse_element(out, i);
+					skip_space();
+					if (!consume(',')) {
+						expect(']');
+						return;
+					}
+				}
+			}
+
+			template<typename T>
+			void parse_document(T& out) {
+				skip_space();
+				parse_value(out);
+				skip_space();
+				if (p != end) {
+					fail("Unexpected trailing characters");
+				}
+			}
+		};
+	}
+
+	// Parses json into out. Keys are dispatched straight to the NamedField with
+	// that name; unknown keys and null values are skipped. Containers and maps
+	// are replaced by the parsed contents, and null empties an optional.
+	// std::string_view fields and other character views are left as they are,
+	// since nothing would outlive the call for them to point into.
+	// Throws ParseError on malformed input.
+	template<typename T>
+	void parse_json(std::string_view json, T& out) {
+		detail::InstrumentScope<T> scope(Operation::ParseJson);
+		scope.add_bytes(json.size());
+		detail::JsonParser parser{json};
+		parser.parse_document(out);
+	}
+
+	template<typename T>
+		requires std::default_initializable<T>
+	T parse_json(std::string_view json) {
+		T out{};
+		parse_json(json, out);
+		return out;
+	}
+
+	// Parses into a struct from make_with_resource, so its strings and
+	// containers, and their elements, allocate from resource.
+	template<typename T>
+		requires Reflectable<T>
+	T parse_json(std::string_view json, std::pmr::memory_resource* resource) {
+		auto out = make_with_resource<T>(resource);
+		parse_json(json, out);
+		return out;
+	}
+}
\ No newline at end of file
@@ -1,50 +1,545 @@
 #pragma once
 
 #include <kser/kser.hpp>
+#include <algorithm> 	// max
+#include <array>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <string_view>
+#include <charconv> 	// to_chars
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <span>
 
 namespace kser {
-	template<size_t TPrecision = 2>
-	constexpr bool serialize_json(auto&& value, std::stringstream& ss) {
-		using value_t = decltype(value);
-		using decayed_t = std::decay_t<value_t>;
-		if constexpr (std::same_as<decayed_t, bool>) {
-			ss << std::boolalpha << value;
-			return true;
+	// map keys are written as JSON strings
+	template<typename T>
+	concept JsonKey = std::convertible_to<const T&, std::string_view> || std::integral<T>;
+
+	namespace detail {
+		template<typename T>
+		consteval bool is_json_serializable() {
+			if constexpr (
+				std::same_as<T, bool>
+				|| std::integral<T>
+				|| std::floating_point<T>
+				|| std::assignable_from<std::string&, T>
+				|| Reflectable<T>
+			) {
+				return true;
+			}
+			else if constexpr (IsOptional<T>) {
+				return is_json_serializable<typename T::value_type>();
+			}
+			else if constexpr (IsMap<T>) {
+				return JsonKey<typename T::key_type>
+					&& is_json_serializable<typename T::mapped_type>();
+			}
+			else if constexpr (IsSequence<T>) {
+				return is_json_serializable<std::ranges::range_value_t<T>>();
+			}
+			else {
+				return false;
+			}
+		}
+	}
+
+	template<typename T>
+	concept JsonSerializable = detail::is_json_serializable<T>();
+
+	namespace detail {
+		template<typename TIt>
+		struct JsonIteratorSink {
+			TIt it;
+
+			constexpr void put(char c) {
+				*it++ = c;
+			}
+
+			constexpr void write(std::string_view s) {
+				it = std::copy(s.begin(), s.end(), it);
+			}
+		};
+
+		struct JsonStringSink {
+			std::string& out;
+
+			constexpr void put(char c) {
+				out.push_back(c);
+			}
+
+			constexpr void write(std::string_view s) {
+				out.append(s);
+			}
+		};
+
+		// counts the characters written through it, so instrumentation can
+		// count the bytes written to any sink
+		template<typename TSink>
+		struct JsonCountingSink {
+			TSink& sink;
+			std::size_t count = 0;
+
+			constexpr void put(char c) {
+				++count;
+				sink.put(c);
+			}
+
+			constexpr void write(std::string_view s) {
+				count += s.size();
+				sink.write(s);
+			}
+		};
+
+		constexpr void write_json_string(auto& sink, std::string_view s) {
+			constexpr char hex[] = "0123456789abcdef";
+			sink.put('"');
+			// copy runs of characters that don't need escaping in one go
+			std::size_t run = 0;
+			for (std::size_t i = 0; i < s.size(); ++i) {
+				auto c = static_cast<unsigned char>(s[i]);
+				if (c >= 0x20 && c != '"' && c != '\\') {
+					continue;
+				}
+				sink.write(s.substr(run, i - run));
+				run = i + 1;
+				switch (c) {
+					case '"': sink.write("\\\""); break;
+					case '\\': sink.write("\\\\"); break;
+					case '\b': sink.write("\\b"); break;
+					case '\f': sink.write("\\f"); break;
+					case '\n': sink.write("\\n"); break;
+					case '\r': sink.write("\\r"); break;
+					case '\t': sink.write("\\t"); break;
+					default: {
+						char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+						sink.write({escaped, sizeof(escaped)});
+					}
+				}
+			}
+			sink.write(s.substr(run));
+			sink.put('"');
+		}
+
+		// longest text write_json_number can produce for a V
+		template<typename V, size_t TPrecision>
+		inline constexpr std::size_t json_number_max_size = std::floating_point<V>
+			// sign, integer digits, decimal point, and fraction digits
+			? std::numeric_limits<V>::max_exponent10 + TPrecision + 4
+			: std::numeric_limits<V>::digits10 + 3;
+
+		template<size_t TPrecision, typename V>
+		constexpr char* format_json_number(char* first, char* last, V value) {
+			if constexpr (std::floating_point<V>) {
+				return std::to_chars(first, last, value, std::chars_format::fixed, TPrecision).ptr;
+			}
+			else {
+				return std::to_chars(first, last, value).ptr;
+			}
+		}
+
+		template<size_t TPrecision>
+		constexpr void write_json_number(auto& sink, auto value) {
+			char buf[json_number_max_size<decltype(value), TPrecision>];
+			sink.write({buf, format_json_number<TPrecision>(buf, buf + sizeof(buf), value)});
+		}
+
+		// Formats a contiguous array of numbers into a local buffer and hands it
+		// to the sink a chunk at a time, rather than making one write per number.
+		template<size_t TPrecision, typename V>
+		constexpr void write_json_number_array(auto& sink, std::span<const V> values) {
+			// a number and its separator
+			constexpr std::size_t max_size = json_number_max_size<V, TPrecision> + 2;
+			char buf[std::max<std::size_t>(4096, 8 * max_size)];
+			char* p = buf;
+			char* last = buf + sizeof(buf);
+			sink.put('[');
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				if (static_cast<std::size_t>(last - p) < max_size) {
+					sink.write({buf, p});
+					p = buf;
+				}
+				if (i != 0) {
+					*p++ = ',';
+					*p++ = ' ';
+				}
+				p = format_json_number<TPrecision>(p, last, values[i]);
+			}
+			sink.write({buf, p});
+			sink.put(']');
+		}
+
+		// All the text of a struct's JSON other than the values, known at compile time.
+		// Fragment I is written before the I-th field's value (and is empty if that
+		// field isn't serializable), and the last fragment closes the object:
+		// {"a": 1, "b": 2}
+		// ^^^^^^   ^^^^^^ ^
+		template<typename T>
+		constexpr std::string json_key_text(std::size_t* offsets = nullptr) {
+			std::string out;
+			JsonStringSink sink{out};
+			bool first = true;
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				(([&] {
+					if (offsets) {
+						offsets[I] = out.size();
+					}
+					if constexpr (JsonSerializable<field_value_at_t<T, I>>) {
+						sink.write(first ? "{" : ", ");
+						first = false;
+						write_json_string(sink, field_names<T>[I]);
+						sink.write(": ");
+					}
+				}()), ...);
+			}(std::make_index_sequence<field_members<T>.size()>{});
+			if (offsets) {
+				offsets[field_members<T>.size()] = out.size();
+			}
+			sink.write(first ? "{}" : "}");
+			return out;
+		}
+
+		template<typename T>
+		inline constexpr auto json_key_offsets = [] {
+			std::array<std::size_t, field_members<T>.size() + 2> out{};
+			out.back() = json_key_text<T>(out.data()).size();
+			return out;
+		}();
+
+		template<typename T>
+		inline constexpr auto json_key_chars = [] {
+			std::array<char, json_key_offsets<T>.back()> out{};
+			auto text = json_key_text<T>();
+			std::copy(text.begin(), text.end(), out.begin());
+			return out;
+		}();
+
+		template<typename T>
+		constexpr std::string_view json_key_fragment(std::size_t i) {
+			return {
+				json_key_chars<T>.data() + json_key_offsets<T>[i],
+				json_key_chars<T>.data() + json_key_offsets<T>[i + 1],
+			};
+		}
+
+		template<typename TSink, size_t TPrecision>
+		struct JsonWriter {
+			TSink& sink;
+			// whether nothing has been written in the current array or object yet
+			bool first = true;
+			// whether the next value is the value for a key just written
+			bool after_key = false;
+
+			// for instrumentation, which counts the characters written for each field
+			static constexpr Operation operation = Operation::SerializeJson;
+
+			constexpr std::size_t written() const requires requires(const TSink& s) { s.count; } {
+				return sink.count;
+			}
+
+			// writes the ", " before an element or key, if it needs one
+			constexpr void separate() {
+				if (after_key) {
+					after_key = false;
+				}
+				else if (!first) {
+					sink.write(", ");
+				}
+				first = false;
+			}
+
+			constexpr void null() {
+				separate();
+				sink.write("null");
+			}
+
+			constexpr void boolean(bool value) {
+				separate();
+				sink.write(value ? "true" : "false");
+			}
+
+			constexpr void number(auto value) {
+				separate();
+				write_json_number<TPrecision>(sink, value);
+			}
+
+			template<typename V>
+			constexpr void number_array(std::span<const V> values) {
+				separate();
+				write_json_number_array<TPrecision>(sink, values);
+			}
+
+			constexpr void string(std::string_view s) {
+				separate();
+				write_json_string(sink, s);
+			}
+
+			constexpr void begin_array(std::size_t) {
+				separate();
+				sink.put('[');
+				first = true;
+			}
+
+			constexpr void end_array() {
+				sink.put(']');
+				first = false;
+			}
+
+			constexpr void begin_object(std::size_t) {
+				separate();
+				sink.put('{');
+				first = true;
+			}
+
+			constexpr void end_object() {
+				sink.put('}');
+				first = false;
+			}
+
+			constexpr void key(std::string_view key) {
+				separate();
+				write_json_string(sink, key);
+				sink.write(": ");
+				after_key = true;
+			}
+
+			constexpr void key(std::integral auto key) {
+				separate();
+				sink.put('"');
+				write_json_number<TPrecision>(sink, key);
+				sink.write("\": ");
+				after_key = true;
+			}
+
+			// structs are written with their precomputed key text
+
+			template<typename T>
+			constexpr void begin_struct() {
+				separate();
+			}
+
+			template<typename T, std::size_t I>
+			constexpr void struct_key() {
+				sink.write(json_key_fragment<T>(I));
+				after_key = true;
+			}
+
+			template<typename T>
+			constexpr void end_struct() {
+				sink.write(json_key_fragment<T>(field_members<T>.size()));
+				first = false;
+			}
+		};
+	}
+
+	// Receives a value from serialize one part at a time, to write it in some
+	// format. Objects are structs (with their field names as keys) and maps
+	// (with string or integer keys), and begin_array and begin_object are given
+	// the number of elements or entries that follow. A writer can also have
+	// - key(std::integral auto), for integer map keys, which are otherwise
+	//   passed to key as decimal strings
+	// - number_array(std::span<const V>), for contiguous arrays of numbers
+	// - begin_struct<T>(), struct_key<T, I>() and end_struct<T>(), used for
+	//   structs instead of begin_object, key and end_object, so the writer can
+	//   precompute whatever surrounds the field values
+	template<typename T>
+	concept Writer = requires(T& writer, std::string_view s, std::size_t n) {
+		writer.null();
+		writer.boolean(true);
+		writer.number(0);
+		writer.number(0.0);
+		writer.string(s);
+		writer.begin_array(n);
+		writer.end_array();
+		writer.begin_object(n);
+		writer.key(s);
+		writer.end_object();
+	};
+
+	namespace detail {
+		template<typename TWriter>
+		constexpr void write_value(TWriter& writer, const auto& value);
+
+		template<typename TWriter, std::size_t... I>
+		constexpr void write_fields(TWriter& writer, const auto& value, std::index_sequence<I...>) {
+			using struct_t = std::remove_cvref_t<decltype(value)>;
+			constexpr bool struct_hooks = requires { writer.template begin_struct<struct_t>(); };
+			auto& [...x] = value;
+			if constexpr (struct_hooks) {
+				writer.template begin_struct<struct_t>();
+			}
+			else {
+				writer.begin_object((0 + ... + std::size_t{JsonSerializable<field_value_at_t<struct_t, I>>}));
+			}
+			([&] {
+				if constexpr (JsonSerializable<field_value_at_t<struct_t, I>>) {
+					if constexpr (struct_hooks) {
+						writer.template struct_key<struct_t, I>();
+					}
+					else {
+						writer.key(field_names<struct_t>[I]);
+					}
+					if constexpr (instrumentation_enabled && requires { writer.written(); }) {
+						auto start = writer.written();
+						write_value(writer, x...[field_members<struct_t>[I]].value);
+						instrument_field<struct_t>(TWriter::operation, I, writer.written() - start);
+					}
+					else {
+						write_value(writer, x...[field_members<struct_t>[I]].value);
+					}
+				}
+			}(), ...);
+			if constexpr (struct_hooks) {
+				writer.template end_struct<struct_t>();
+			}
+			else {
+				writer.end_object();
+			}
+		}
+
+		template<typename TWriter>
+		constexpr void write_value(TWriter& writer, const auto& value) {
+			using decayed_t = std::decay_t<decltype(value)>;
+			if constexpr (std::same_as<decayed_t, bool>) {
+				writer.boolean(value);
+			}
+			else if constexpr (std::integral<decayed_t> || std::floating_point<decayed_t>) {
+				writer.number(value);
+			}
+			else if constexpr (std::convertible_to<const decayed_t&, std::string_view>) {
+				writer.string(value);
+			}
+			else if constexpr (std::assignable_from<std::string&, decayed_t>) {
+				std::string s;
+				s = value;
+				writer.string(s);
+			}
+			else if constexpr (IsOptional<decayed_t>) {
+				if (value) {
+					write_value(writer, *value);
+				}
+				else {
+					writer.null();
+				}
+			}
+			else if constexpr (IsMap<decayed_t>) {
+				using key_t = typename decayed_t::key_type;
+				writer.begin_object(static_cast<std::size_t>(std::ranges::distance(value)));
+				for (const auto& [key, mapped] : value) {
+					if constexpr (!std::integral<key_t>) {
+						writer.key(key);
+					}
+					else if constexpr (requires { writer.key(key); }) {
+						writer.key(key);
+					}
+					else {
+						char buf[std::numeric_limits<key_t>::digits10 + 3];
+						writer.key(std::string_view{buf, std::to_chars(buf, buf + sizeof(buf), key).ptr});
+					}
+					write_value(writer, mapped);
+				}
+				writer.end_object();
+			}
+			else if constexpr (IsSequence<decayed_t>) {
+				using element_t = std::ranges::range_value_t<decayed_t>;
+				if constexpr (
+					std::ranges::contiguous_range<const decayed_t>
+					&& std::is_arithmetic_v<element_t>
+					&& !std::same_as<element_t, bool>
+					&& requires(std::span<const element_t> values) { writer.number_array(values); }
+				) {
+					writer.number_array(
+						std::span<const element_t>(std::ranges::data(value), std::ranges::size(value))
+					);
+				}
+				else {
+					writer.begin_array(static_cast<std::size_t>(std::ranges::distance(value)));
+					for (const auto& element : value) {
+						// converts proxies such as std::vector<bool>'s
+						write_value(writer, static_cast<const element_t&>(element));
+					}
+					writer.end_array();
+				}
+			}
+			else if constexpr (Reflectable<decayed_t>) {
+				write_fields(
+					writer,
+					value,
+					std::make_index_sequence<field_members<decayed_t>.size()>{}
+				);
+			}
+		}
+
+		template<size_t TPrecision>
+		constexpr void write_json(auto& sink, const auto& value) {
+			using sink_t = std::remove_reference_t<decltype(sink)>;
+			InstrumentScope<std::decay_t<decltype(value)>> scope(Operation::SerializeJson);
+			if constexpr (instrumentation_enabled) {
+				JsonCountingSink<sink_t> counting{sink};
+				JsonWriter<JsonCountingSink<sink_t>, TPrecision> writer{counting};
+				write_value(writer, value);
+				scope.add_bytes(counting.count);
+			}
+			else {
+				JsonWriter<sink_t, TPrecision> writer{sink};
+				write_value(writer, value);
+			}
 		}
-		else if constexpr (std::integral<decayed_t> || std::floating_point<decayed_t>) {
-			ss << std::fixed << std::setprecision(TPrecision) << value;
+	}
+
+	// Walks value and hands each part of it to writer, so a format only has to
+	// say how to write the parts; serialize_json, serialize_msgpack and
+	// serialize_cbor are all built on this. Returns false, writing nothing, if
+	// value can't be serialized (isn't JsonSerializable).
+	template<Writer TWriter>
+	constexpr bool serialize(TWriter& writer, const auto& value) {
+		if constexpr (JsonSerializable<std::decay_t<decltype(value)>>) {
+			detail::write_value(writer, value);
 			return true;
 		}
-		else if constexpr (std::assignable_from<std::string&, decayed_t>) {
-			ss << std::quoted(std::string(value));
+		else {
+			return false;
+		}
+	}
+
+	// Writes value as JSON through an output iterator, returning the iterator past
+	// the last character written. Nothing is written for unserializable types.
+	template<size_t TPrecision = 2, std::output_iterator<char> TIt>
+	constexpr TIt serialize_json_to(TIt out, const auto& value) {
+		detail::JsonIteratorSink<TIt> sink{out};
+		detail::write_json<TPrecision>(sink, value);
+		return sink.it;
+	}
+
+	// Appends value as JSON to out. Reusing out between calls avoids
+	// allocating once it has grown large enough.
+	template<size_t TPrecision = 2>
+	constexpr bool serialize_json(const auto& value, std::string& out) {
+		if constexpr (JsonSerializable<std::decay_t<decltype(value)>>) {
+			detail::JsonStringSink sink{out};
+			detail::write_json<TPrecision>(sink, value);
 			return true;
 		}
-		else if constexpr (requires { kser::get_value<int>(value, std::declval<std::string_view>()); }) {
-			bool first = true;
-			ss << "{";
-			kser::visit_name_values(value, [&ss, &first](auto&& name, auto&& v) {
-				std::stringstream ss2;
-				if(serialize_json(v, ss2)){
-					if (!first) {
-						ss << ", ";
-					}
-					first = false;
-					ss << std::quoted(name) << ": " << ss2.str();
-				}
-			});
-			ss << "}";
+		else {
+			return false;
+		}
+	}
+
+	template<size_t TPrecision = 2>
+	bool serialize_json(const auto& value, std::ostream& os) {
+		if constexpr (JsonSerializable<std::decay_t<decltype(value)>>) {
+			serialize_json_to<TPrecision>(std::ostreambuf_iterator<char>(os), value);
 			return true;
 		}
-		return false;
+		else {
+			return false;
+		}
 	}
 
 	template<size_t TPrecision = 2>
-	constexpr std::string serialize_json(auto&& s){
-		std::stringstream ss;
-		serialize_json<TPrecision>(s, ss);
-		return ss.str();
+	constexpr std::string serialize_json(const auto& s){
+		std::string out;
+		serialize_json<TPrecision>(s, out);
+		return out;
 	}
 }
\ No newline at end of file
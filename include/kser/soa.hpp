@@ -0,0 +1,208 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace kser {
+	// std::vector<bool> packs bits and can't hand out a bool&,
+	// so bool columns hold these instead
+	struct SoaBool {
+		bool value = false;
+
+		SoaBool() = default;
+		SoaBool(bool value) : value(value) {}
+
+		operator bool&() {
+			return value;
+		}
+
+		operator const bool&() const {
+			return value;
+		}
+	};
+
+	namespace detail {
+		template<typename V>
+		using soa_column_t = std::vector<std::conditional_t<std::same_as<V, bool>, SoaBool, V>>;
+
+		// the NamedField with the same name, holding a reference to V instead
+		template<typename TField, bool Const>
+		struct field_reference;
+
+		template<typename V, StaticString Name, bool Const>
+		struct field_reference<NamedField<V, Name>, Const> {
+			using type = NamedField<std::conditional_t<Const, const V&, V&>, Name>;
+		};
+
+		template<typename T>
+		using field_indices = std::make_index_sequence<field_members<T>.size()>;
+	}
+
+	// One element of a SoaVector: a struct of references to the element's value
+	// in each column, with the same field names as T. It is Reflectable itself,
+	// so visit_fields, get_value, set_value and the rest work on it as they do
+	// on a T, reading and writing the columns.
+	template<typename T, bool Const, typename = detail::field_indices<T>>
+	struct SoaReference;
+
+	template<typename T, bool Const, std::size_t... I>
+	struct SoaReference<T, Const, std::index_sequence<I...>> {
+		std::tuple<typename detail::field_reference<detail::field_at_t<T, I>, Const>::type...> fields;
+
+		template<std::size_t J>
+		auto& get() {
+			return std::get<J>(fields);
+		}
+
+		template<std::size_t J>
+		const auto& get() const {
+			return std::get<J>(fields);
+		}
+
+		// copies the element out
+		explicit operator T() const {
+			T out{};
+			((kser::get<I>(out) = std::get<I>(fields).value), ...);
+			return out;
+		}
+	};
+}
+
+template<typename T, bool Const, typename TIndices>
+struct std::tuple_size<kser::SoaReference<T, Const, TIndices>>
+	: std::integral_constant<std::size_t, kser::detail::field_members<T>.size()> {};
+
+template<std::size_t J, typename T, bool Const, typename TIndices>
+struct std::tuple_element<J, kser::SoaReference<T, Const, TIndices>> {
+	using type = std::tuple_element_t<J, decltype(kser::SoaReference<T, Const, TIndices>::fields)>;
+};
+
+namespace kser {
+	// A vector of T stored as one contiguous std::vector per NamedField, so
+	// loops over one or two fields only touch those fields' memory. Members
+	// that aren't NamedFields aren't stored.
+	template<typename T>
+		requires Reflectable<T> && (detail::field_members<T>.size() > 0)
+	class SoaVector {
+		static constexpr std::size_t field_count = detail::field_members<T>.size();
+
+		template<typename TIndices>
+		struct columns_for;
+
+		template<std::size_t... I>
+		struct columns_for<std::index_sequence<I...>> {
+			using type = std::tuple<detail::soa_column_t<detail::field_value_at_t<T, I>>...>;
+		};
+
+	public:
+		using value_type = T;
+		using reference = SoaReference<T, false>;
+		using const_reference = SoaReference<T, true>;
+
+		std::size_t size() const {
+			return std::get<0>(columns).size();
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+
+		void reserve(std::size_t n) {
+			for_each_column([&](auto& column) {
+				column.reserve(n);
+			});
+		}
+
+		void resize(std::size_t n) {
+			for_each_column([&](auto& column) {
+				column.resize(n);
+			});
+		}
+
+		void clear() {
+			for_each_column([](auto& column) {
+				column.clear();
+			});
+		}
+
+		void push_back(const T& value) {
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				(column<I>().push_back(kser::get<I>(value)), ...);
+			}(std::make_index_sequence<field_count>{});
+		}
+
+		void pop_back() {
+			for_each_column([](auto& column) {
+				column.pop_back();
+			});
+		}
+
+		reference operator [](std::size_t i) {
+			return element<reference>(*this, i);
+		}
+
+		const_reference operator [](std::size_t i) const {
+			return element<const_reference>(*this, i);
+		}
+
+		template<std::size_t I>
+			requires (I < field_count)
+		auto& column() {
+			return std::get<I>(columns);
+		}
+
+		template<std::size_t I>
+			requires (I < field_count)
+		const auto& column() const {
+			return std::get<I>(columns);
+		}
+
+		template<StaticString Name>
+		auto& column() {
+			return column<field_index<T, Name>>();
+		}
+
+		template<StaticString Name>
+		const auto& column() const {
+			return column<field_index<T, Name>>();
+		}
+
+		// calls f with the column for the field called name, returning false if there isn't one
+		bool visit_column(std::string_view name, auto&& f) {
+			return visit_column_at(*this, detail::name_table<T>.find(name), f);
+		}
+
+		bool visit_column(std::string_view name, auto&& f) const {
+			return visit_column_at(*this, detail::name_table<T>.find(name), f);
+		}
+
+	private:
+		void for_each_column(auto&& f) {
+			std::apply([&](auto&... column) {
+				(f(column), ...);
+			}, columns);
+		}
+
+		template<typename TReference>
+		static TReference element(auto& self, std::size_t i) {
+			using fields_t = decltype(TReference::fields);
+			return [&]<std::size_t... I>(std::index_sequence<I...>) {
+				return TReference{
+					fields_t{std::tuple_element_t<I, fields_t>{{self.template column<I>()[i]}}...}
+				};
+			}(std::make_index_sequence<field_count>{});
+		}
+
+		static bool visit_column_at(auto& self, std::size_t i, auto& f) {
+			return [&]<std::size_t... I>(std::index_sequence<I...>) {
+				return (... || (I == i && (f(self.template column<I>()), true)));
+			}(std::make_index_sequence<field_count>{});
+		}
+
+		typename columns_for<std::make_index_sequence<field_count>>::type columns;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,657 @@
+#pragma once
+
+#include <kser/parse.hpp>
+#include <charconv> 	// from_chars
+#include <memory> 		// unique_ptr
+#include <string>
+#include <string_view>
+#include <vector>
+#include <version> 		// __cpp_lib_generator
+
+#ifdef __cpp_lib_generator
+#include <generator>
+#endif
+
+namespace kser {
+	namespace detail {
+		struct JsonStream;
+		struct StreamValueOps;
+
+		// where the next value goes; ops is nullptr for values that are skipped
+		struct StreamTarget {
+			void* out = nullptr;
+			const StreamValueOps* ops = nullptr;
+		};
+
+		// How to fill in a value of some type. The streaming parser can't keep
+		// its place in a stack of typed calls between chunks, so it keeps a stack
+		// of frames that point to these instead.
+		struct StreamValueOps {
+			// a whole string, number or literal, or a character that can't start this value
+			void (*scalar)(JsonStream& stream, void* out, std::string_view token);
+			// '{' or '['
+			void (*open)(JsonStream& stream, void* out, char c);
+			// the value of the Field<V> returned by field_getters
+			void* (*field_value)(void* field);
+		};
+
+		struct StreamFrame;
+
+		struct StreamContainerOps {
+			// for objects: the value for key
+			StreamTarget (*member)(JsonStream& stream, void* out, std::string_view key) = nullptr;
+			// for arrays: the i-th element
+			StreamTarget (*element)(JsonStream& stream, StreamFrame& frame, std::size_t i) = nullptr;
+			// for arrays filled through a temporary: moves it into the array
+			void (*commit)(StreamFrame& frame) = nullptr;
+		};
+
+		enum class StreamFrameKind {
+			Root,
+			Object,
+			Array,
+		};
+
+		// what the frame expects next
+		enum class StreamState {
+			KeyOrEnd,
+			Key,
+			Colon,
+			Value,
+			ValueOrEnd,
+			CommaOrEnd,
+			Done,
+		};
+
+		// the value being parsed, or an object or array inside it
+		struct StreamFrame {
+			StreamFrameKind kind;
+			StreamState state;
+			void* out = nullptr;
+			// nullptr for objects and arrays that are skipped
+			const StreamContainerOps* ops = nullptr;
+			// the current member or element
+			StreamTarget value{};
+			std::size_t count = 0;
+			// elements of arrays without emplace_back, such as std::vector<bool>
+			std::unique_ptr<void, void (*)(void*)> temp{nullptr, nullptr};
+		};
+
+		enum class StreamToken {
+			None,
+			String,
+			Number,
+			Literal,
+		};
+
+		struct JsonStream {
+			StreamTarget root;
+			std::vector<StreamFrame> frames;
+
+			// the chunk being fed
+			const char* chunk_begin = nullptr;
+			const char* p = nullptr;
+			const char* end = nullptr;
+			// characters fed before chunk_begin
+			std::size_t position = 0;
+			// offset of the token or character being handled, for errors
+			std::size_t at = 0;
+
+			// a token is only copied into token if it is split between chunks
+			StreamToken token_kind = StreamToken::None;
+			const char* token_start = nullptr;
+			std::size_t token_offset = 0;
+			std::string token;
+			// the chunk ended just after a backslash in a string
+			bool escaped = false;
+
+			explicit JsonStream(StreamTarget root) : root(root) {
+				reset();
+			}
+
+			void reset() {
+				frames.clear();
+				frames.push_back({StreamFrameKind::Root, StreamState::Value, nullptr, nullptr, root});
+				token_kind = StreamToken::None;
+				token.clear();
+				escaped = false;
+			}
+
+			bool done() const {
+				return frames.front().state == StreamState::Done;
+			}
+
+			bool empty() const {
+				return frames.size() == 1
+					&& frames.front().state == StreamState::Value
+					&& token_kind == StreamToken::None;
+			}
+
+			std::size_t offset() const {
+				return position + static_cast<std::size_t>(p - chunk_begin);
+			}
+
+			[[noreturn]] void fail(std::string_view what) const {
+				throw ParseError(what, at);
+			}
+
+			std::size_t feed(std::string_view chunk) {
+				chunk_begin = chunk.data();
+				p = chunk_begin;
+				end = chunk_begin + chunk.size();
+				token_start = p;
+				if (token_kind != StreamToken::None && p != end) {
+					scan_token();
+				}
+				while (p != end && !done()) {
+					p = skip_json_space(p, end);
+					if (p == end) {
+						break;
+					}
+					auto c = *p;
+					if (c == '"') {
+						start_token(StreamToken::String);
+					}
+					else if (is_number_char(c)) {
+						start_token(StreamToken::Number);
+					}
+					else if (is_literal_char(c)) {
+						start_token(StreamToken::Literal);
+					}
+					else {
+						at = offset();
+						on_char(c);
+					}
+				}
+				auto used = static_cast<std::size_t>(p - chunk_begin);
+				position += used;
+				chunk_begin = p = end = nullptr;
+				return used;
+			}
+
+			void finish() {
+				if (token_kind == StreamToken::String) {
+					at = position;
+					fail("Unterminated string");
+				}
+				if (token_kind != StreamToken::None) {
+					// numbers and literals end at the next character, and there isn't one
+					end_token(token);
+				}
+				if (!done()) {
+					at = position;
+					fail("Unexpected end of input");
+				}
+			}
+
+			static bool is_literal_char(char c) {
+				return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+			}
+
+			void start_token(StreamToken kind) {
+				token_kind = kind;
+				token_start = p;
+				token_offset = offset();
+				if (kind == StreamToken::String) {
+					++p;
+				}
+				scan_token();
+			}
+
+			// continues the current token, handling it if it ends in this chunk
+			void scan_token() {
+				switch (token_kind) {
+					case StreamToken::String:
+						while (true) {
+							if (escaped) {
+								++p;
+								escaped = false;
+							}
+							p = find_json_string_special(p, end);
+							if (p == end) {
+								break;
+							}
+							if (*p == '"') {
+								++p;
+								return end_token();
+							}
+							if (*p == '\\' && end - p < 2) {
+								p = end;
+								escaped = true;
+								break;
+							}
+							// control characters are reported when the string is parsed
+							p += *p == '\\' ? 2 : 1;
+						}
+						break;
+					case StreamToken::Number:
+						while (p != end && is_number_char(*p)) {
+							++p;
+						}
+						if (p != end) {
+							return end_token();
+						}
+						break;
+					default:
+						while (p != end && is_literal_char(*p)) {
+							++p;
+						}
+						if (p != end) {
+							return end_token();
+						}
+				}
+				token.append(token_start, end);
+			}
+
+			void end_token() {
+				if (token.empty()) {
+					end_token({token_start, p});
+				}
+				else {
+					token.append(token_start, p);
+					end_token(token);
+				}
+			}
+
+			void end_token(std::string_view text) {
+				auto kind = token_kind;
+				token_kind = StreamToken::None;
+				at = token_offset;
+				auto& frame = frames.back();
+				if (
+					frame.kind == StreamFrameKind::Object
+					&& (frame.state == StreamState::KeyOrEnd || frame.state == StreamState::Key)
+				) {
+					if (kind != StreamToken::String) {
+						fail("Expected string");
+					}
+					JsonParser parser{text};
+					parser.base = at;
+					auto key = parser.parse_key();
+					frame.value = frame.ops ? frame.ops->member(*this, frame.out, key) : StreamTarget{};
+					frame.state = StreamState::Colon;
+				}
+				else {
+					if (!expects_value(frame)) {
+						fail_unexpected(frame);
+					}
+					scalar(begin_value(frame), text);
+					end_value();
+				}
+				token.clear();
+			}
+
+			void on_char(char c) {
+				auto& frame = frames.back();
+				if (c == '{' || c == '[') {
+					if (!expects_value(frame)) {
+						fail_unexpected(frame);
+					}
+					auto target = begin_value(frame);
+					++p;
+					if (target.ops) {
+						target.ops->open(*this, target.out, c);
+					}
+					else {
+						push(c, nullptr, nullptr);
+					}
+					return;
+				}
+				if (
+					(c == '}' && frame.kind == StreamFrameKind::Object
+						&& (frame.state == StreamState::KeyOrEnd || frame.state == StreamState::CommaOrEnd))
+					|| (c == ']' && frame.kind == StreamFrameKind::Array
+						&& (frame.state == StreamState::ValueOrEnd || frame.state == StreamState::CommaOrEnd))
+				) {
+					++p;
+					frames.pop_back();
+					end_value();
+				}
+				else if (c == ':' && frame.state == StreamState::Colon) {
+					++p;
+					frame.state = StreamState::Value;
+				}
+				else if (c == ',' && frame.state == StreamState::CommaOrEnd) {
+					++p;
+					frame.state = frame.kind == StreamFrameKind::Object ? StreamState::Key : StreamState::Value;
+				}
+				else if (expects_value(frame)) {
+					// reports the same error parse_json would for this value
+					scalar(begin_value(frame), {&c, 1});
+					fail("Unexpected character");
+				}
+				else {
+					fail_unexpected(frame);
+				}
+			}
+
+			// starts an object or array for a '{' or '['
+			void push(char c, void* out, const StreamContainerOps* ops) {
+				if (c == '{') {
+					frames.push_back({StreamFrameKind::Object, StreamState::KeyOrEnd, out, ops});
+				}
+				else {
+					frames.push_back({StreamFrameKind::Array, StreamState::ValueOrEnd, out, ops});
+				}
+			}
+
+			static bool expects_value(const StreamFrame& frame) {
+				return frame.state == StreamState::Value
+					|| (frame.kind == StreamFrameKind::Array && frame.state == StreamState::ValueOrEnd);
+			}
+
+			StreamTarget begin_value(StreamFrame& frame) {
+				if (frame.kind == StreamFrameKind::Array) {
+					frame.value = frame.ops ? frame.ops->element(*this, frame, frame.count) : StreamTarget{};
+					++frame.count;
+				}
+				return frame.value;
+			}
+
+			void end_value() {
+				auto& frame = frames.back();
+				if (frame.kind == StreamFrameKind::Root) {
+					frame.state = StreamState::Done;
+					return;
+				}
+				if (frame.kind == StreamFrameKind::Array && frame.ops && frame.ops->commit) {
+					frame.ops->commit(frame);
+				}
+				frame.state = StreamState::CommaOrEnd;
+			}
+
+			void scalar(StreamTarget target, std::string_view text) {
+				if (target.ops) {
+					target.ops->scalar(*this, target.out, text);
+				}
+				else {
+					JsonParser parser{text};
+					parser.base = at;
+					parser.skip_value();
+					if (parser.p != parser.end) {
+						parser.fail("Unexpected character");
+					}
+				}
+			}
+
+			[[noreturn]] void fail_unexpected(const StreamFrame& frame) const {
+				if (frame.state == StreamState::KeyOrEnd || frame.state == StreamState::Key) {
+					fail("Expected string");
+				}
+				if (frame.state == StreamState::Colon) {
+					fail("Expected ':'");
+				}
+				if (frame.state == StreamState::CommaOrEnd) {
+					fail(frame.kind == StreamFrameKind::Object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+				}
+				fail("Unexpected character");
+			}
+		};
+
+		template<typename V>
+		const StreamValueOps* stream_value_ops();
+
+		template<typename T>
+		const StreamContainerOps* stream_struct_ops();
+
+		template<typename T>
+		const StreamContainerOps* stream_map_ops();
+
+		template<typename T>
+		const StreamContainerOps* stream_array_ops();
+
+		template<typename V>
+		void stream_scalar(JsonStream& stream, void* out, std::string_view token) {
+			JsonParser parser{token};
+			parser.base = stream.at;
+			parser.parse_value(*static_cast<V*>(out));
+			if (parser.p != parser.end) {
+				parser.fail("Unexpected character");
+			}
+		}
+
+		// the same cases, in the same order, as JsonParser::parse_value
+		template<typename V>
+		void stream_open(JsonStream& stream, void* out, char c) {
+			auto& value = *static_cast<V*>(out);
+			if constexpr (
+				std::same_as<V, bool>
+				|| std::integral<V>
+				|| std::floating_point<V>
+				|| IsString<V>
+			) {
+				stream_scalar<V>(stream, out, {&c, 1});
+				stream.fail("Unexpected character");
+			}
+			else if constexpr (IsStringView<V>) {
+				stream.push(c, nullptr, nullptr);
+			}
+			else if constexpr (IsOptional<V>) {
+				stream_open<typename V::value_type>(stream, value ? &*value : &value.emplace(), c);
+			}
+			else if constexpr (IsMap<V>) {
+				if (c != '{') {
+					stream.fail("Expected '{'");
+				}
+				value.clear();
+				stream.push(c, out, stream_map_ops<V>());
+			}
+			else if constexpr (IsSequence<V>) {
+				if (c != '[') {
+					stream.fail("Expected '['");
+				}
+				if constexpr (requires { value.clear(); }) {
+					value.clear();
+				}
+				stream.push(c, out, stream_array_ops<V>());
+			}
+			else if constexpr (AssignableFromString<V>) {
+				stream_scalar<V>(stream, out, {&c, 1});
+				stream.fail("Unexpected character");
+			}
+			else if constexpr (Reflectable<V>) {
+				if (c != '{') {
+					stream.fail("Expected '{'");
+				}
+				stream.push(c, out, stream_struct_ops<V>());
+			}
+			else {
+				stream.push(c, nullptr, nullptr);
+			}
+		}
+
+		template<typename V>
+		const StreamValueOps* stream_value_ops() {
+			static constexpr StreamValueOps ops{
+				stream_scalar<V>,
+				stream_open<V>,
+				[](void* field) -> void* {
+					return &static_cast<Field<V>*>(field)->value;
+				},
+			};
+			return &ops;
+		}
+
+		// keys go through the same tables as get_value: the name's index, then
+		// the field's getter and the ops for its value type
+		template<typename T>
+		const StreamContainerOps* stream_struct_ops() {
+			static const auto field_ops = []<std::size_t... D>(std::index_sequence<D...>) {
+				using types_t = field_value_types_t<T>;
+				return std::array<const StreamValueOps*, sizeof...(D)>{
+					stream_value_ops<typename types_t::template at<D>>()...
+				};
+			}(std::make_index_sequence<field_value_types_t<T>::size>{});
+			static constexpr StreamContainerOps ops{
+				.member = [](JsonStream&, void* out, std::string_view key) -> StreamTarget {
+					auto i = name_table<T>.find(key);
+					if (i == name_table<T>.npos) {
+						return {};
+					}
+					auto value_ops = field_ops[field_value_type_indices<T>[i]];
+					return {value_ops->field_value(field_getters<T>[i](out)), value_ops};
+				},
+			};
+			return &ops;
+		}
+
+		template<typename T>
+		const StreamContainerOps* stream_map_ops() {
+			static constexpr StreamContainerOps ops{
+				.member = [](JsonStream& stream, void* out, std::string_view key) -> StreamTarget {
+					using key_t = typename T::key_type;
+					auto& map = *static_cast<T*>(out);
+					auto value_ops = stream_value_ops<typename T::mapped_type>();
+					if constexpr (std::integral<key_t>) {
+						key_t k{};
+						auto result = std::from_chars(key.data(), key.data() + key.size(), k);
+						if (result.ec != std::errc{} || result.ptr != key.data() + key.size()) {
+							stream.fail("Expected integer key");
+						}
+						return {&try_emplace_mapped(map, std::move(k)), value_ops};
+					}
+					else {
+						return {&try_emplace_mapped(map, make_map_key(map, key)), value_ops};
+					}
+				},
+			};
+			return &ops;
+		}
+
+		// the same cases, in the same order, as JsonParser::parse_element
+		template<typename T>
+		const StreamContainerOps* stream_array_ops() {
+			using value_t = std::ranges::range_value_t<T>;
+			static constexpr StreamContainerOps ops = [] {
+				StreamContainerOps out;
+				if constexpr (requires { std::tuple_size<T>::value; }) {
+					out.element = [](JsonStream& stream, StreamFrame& frame, std::size_t i) -> StreamTarget {
+						if (i >= std::tuple_size_v<T>) {
+							stream.fail("Too many elements");
+						}
+						return {&(*static_cast<T*>(frame.out))[i], stream_value_ops<value_t>()};
+					};
+				}
+				else if constexpr (requires(T& out) { { out.emplace_back() } -> std::same_as<value_t&>; }) {
+					out.element = [](JsonStream&, StreamFrame& frame, std::size_t) -> StreamTarget {
+						return {&emplace_back_element(*static_cast<T*>(frame.out)), stream_value_ops<value_t>()};
+					};
+				}
+				else if constexpr (
+					requires(T& out, value_t v) { out.push_back(std::move(v)); }
+					|| requires(T& out, value_t v) { out.insert(std::move(v)); }
+				) {
+					out.element = [](JsonStream&, StreamFrame& frame, std::size_t) -> StreamTarget {
+						if (frame.temp) {
+							*static_cast<value_t*>(frame.temp.get()) = value_t{};
+						}
+						else {
+							frame.temp = {new value_t{}, [](void* p) {
+								delete static_cast<value_t*>(p);
+							}};
+						}
+						return {frame.temp.get(), stream_value_ops<value_t>()};
+					};
+					out.commit = [](StreamFrame& frame) {
+						auto& array = *static_cast<T*>(frame.out);
+						auto& value = *static_cast<value_t*>(frame.temp.get());
+						if constexpr (requires { array.push_back(std::move(value)); }) {
+							array.push_back(std::move(value));
+						}
+						else {
+							array.insert(std::move(value));
+						}
+					};
+				}
+				else {
+					out.element = [](JsonStream&, StreamFrame&, std::size_t) -> StreamTarget {
+						return {};
+					};
+				}
+				return out;
+			}();
+			return &ops;
+		}
+	}
+
+	// Parses one JSON value into out from input that arrives a chunk at a time,
+	// such as from a socket, without buffering the whole message. Between
+	// chunks it keeps its place in out and any token split between them.
+	// Parsing is the same as parse_json: keys go straight to the NamedField with
+	// that name, unknown keys are skipped, and malformed input throws ParseError
+	// with the offset into everything fed so far.
+	template<typename T>
+	class JsonStreamParser {
+	public:
+		explicit JsonStreamParser(T& out)
+			: stream({&out, detail::stream_value_ops<T>()}) {}
+
+		// Parses as much of chunk as it can, returning the number of characters
+		// used. This is less than chunk.size() only if the value ended partway
+		// through, leaving the rest (say, the next message) to the caller.
+		std::size_t feed(std::string_view chunk) {
+			detail::InstrumentScope<T> scope(Operation::ParseJsonStream);
+			auto used = stream.feed(chunk);
+			scope.add_bytes(used);
+			return used;
+		}
+
+		// whether the whole value has been parsed
+		bool done() const {
+			return stream.done();
+		}
+
+		// whether nothing but whitespace has been fed since the last reset
+		bool empty() const {
+			return stream.empty();
+		}
+
+		// Call at the end of the input. Completes a number or literal at the very
+		// end, which can't be told apart from one split between chunks until
+		// now, and throws ParseError if the value is incomplete.
+		void finish() {
+			detail::InstrumentScope<T> scope(Operation::ParseJsonStream);
+			stream.finish();
+		}
+
+		// parses the next value into out, which is not cleared first
+		void reset() {
+			stream.reset();
+		}
+
+	private:
+		detail::JsonStream stream;
+	};
+
+#ifdef __cpp_lib_generator
+	// Parses a sequence of values, such as newline delimited JSON, from the
+	// chunks returned by read, yielding each one as soon as its last character
+	// arrives. An empty chunk is the end of the input, and each chunk only has to
+	// live until the next call to read.
+	template<typename T, typename TRead>
+		requires std::default_initializable<T>
+			&& std::convertible_to<std::invoke_result_t<TRead&>, std::string_view>
+	std::generator<T&> parse_json_stream(TRead read) {
+		T value{};
+		JsonStreamParser<T> parser{value};
+		while (true) {
+			std::string_view chunk = read();
+			if (chunk.empty()) {
+				if (!parser.empty()) {
+					parser.finish();
+					co_yield value;
+				}
+				co_return;
+			}
+			while (!chunk.empty()) {
+				chunk.remove_prefix(parser.feed(chunk));
+				if (parser.done()) {
+					co_yield value;
+					value = T{};
+					parser.reset();
+				}
+			}
+		}
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <kser/binary.hpp>
+#include <algorithm> 	// sort, lower_bound, adjacent_find
+#include <array>
+#include <cstddef> 		// byte
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace kser {
+	// A NamedField with an explicit tag for serialize_tagged. Other NamedFields
+	// get a tag from a hash of their name, so renaming one changes its tag;
+	// give it its old tag here to keep reading records written before the rename.
+	template<typename T, StaticString Name, std::uint32_t Tag>
+		requires (Tag > 0 && Tag < (1u << 29))
+	struct TaggedField : NamedField<T, Name> {
+		static constexpr std::uint32_t field_tag() {
+			return Tag;
+		}
+	};
+
+	// The tagged layout is protobuf's wire format, so fields can be added,
+	// removed and reordered without breaking readers on either side:
+	// - each field is a varint key, tag << 3 | wire type, followed by its value
+	// - bools and integers are varints, signed ones zigzag encoded
+	// - floats and doubles are their 4 or 8 little-endian bytes
+	// - strings and reflected structs are a varint length followed by their bytes
+	// - sequences of arithmetic values are packed into one length-prefixed field,
+	//   other sequences repeat the field once per element
+	// - maps repeat the field once per entry, a struct with the key as tag 1
+	//   and the value as tag 2
+	// - empty optionals are left out
+	// Readers skip fields whose tags they don't know using only the wire type.
+	namespace detail {
+		enum class WireType : std::uint8_t {
+			Varint = 0,
+			Fixed64 = 1,
+			LengthDelimited = 2,
+			Fixed32 = 5,
+		};
+
+		// values that are one field on the wire
+		template<typename T>
+		concept TaggedScalar =
+			(std::is_arithmetic_v<T> && (!std::floating_point<T> || sizeof(T) == 4 || sizeof(T) == 8))
+			|| IsString<T>
+			|| Reflectable<T>;
+
+		template<typename T>
+		concept TaggedValue =
+			TaggedScalar<T>
+			|| (IsOptional<T> && TaggedScalar<typename T::value_type>)
+			|| (IsMap<T> && TaggedScalar<typename T::key_type> && TaggedScalar<typename T::mapped_type>)
+			|| (
+				IsSequence<T>
+				&& TaggedScalar<std::ranges::range_value_t<T>>
+				&& requires(T& s) { s.emplace_back(); }
+			);
+
+		template<typename V>
+		constexpr WireType wire_type() {
+			if constexpr (std::floating_point<V>) {
+				return sizeof(V) == 4 ? WireType::Fixed32 : WireType::Fixed64;
+			}
+			else if constexpr (std::is_arithmetic_v<V>) {
+				return WireType::Varint;
+			}
+			else {
+				return WireType::LengthDelimited;
+			}
+		}
+
+		template<typename TField>
+		constexpr std::uint32_t field_tag() {
+			if constexpr (requires { TField::field_tag(); }) {
+				return TField::field_tag();
+			}
+			else {
+				// 1 to 2^29 - 1, the range protobuf allows
+				return static_cast<std::uint32_t>(hash_name(TField::field_name()) % ((1u << 29) - 1)) + 1;
+			}
+		}
+
+		template<typename T>
+		inline constexpr auto field_tags = []<std::size_t... I>(std::index_sequence<I...>) {
+			return std::array<std::uint32_t, sizeof...(I)>{field_tag<field_at_t<T, I>>()...};
+		}(std::make_index_sequence<field_members<T>.size()>{});
+
+		struct TagEntry {
+			std::uint32_t tag;
+			std::size_t index;
+		};
+
+		// field_tags with their field indices, sorted by tag
+		template<typename T>
+		inline constexpr auto tag_table = [] {
+			std::array<TagEntry, field_tags<T>.size()> out{};
+			for (std::size_t i = 0; i < out.size(); ++i) {
+				out[i] = {field_tags<T>[i], i};
+			}
+			std::ranges::sort(out, {}, &TagEntry::tag);
+			return out;
+		}();
+
+		template<typename T>
+		inline constexpr bool tags_unique = std::ranges::adjacent_find(
+			tag_table<T>,
+			{},
+			&TagEntry::tag
+		) == tag_table<T>.end();
+
+		inline constexpr std::size_t tag_npos = static_cast<std::size_t>(-1);
+
+		// index of the field with the given tag, or tag_npos
+		template<typename T>
+		constexpr std::size_t find_tag(std::uint64_t tag, std::size_t hint) {
+			// fields are usually read in the order they were written, so try the next one first
+			if (hint < field_tags<T>.size() && field_tags<T>[hint] == tag) {
+				return hint;
+			}
+			auto it = std::ranges::lower_bound(tag_table<T>, tag, {}, &TagEntry::tag);
+			return it != tag_table<T>.end() && it->tag == tag ? it->index : tag_npos;
+		}
+
+		template<std::integral T>
+		constexpr std::uint64_t zigzag(T value) {
+			if constexpr (std::is_signed_v<T>) {
+				std::int64_t wide = value;
+				return (static_cast<std::uint64_t>(wide) << 1) ^ static_cast<std::uint64_t>(wide >> 63);
+			}
+			else {
+				return value;
+			}
+		}
+
+		template<std::integral T>
+		constexpr T unzigzag(std::uint64_t value) {
+			if constexpr (std::is_signed_v<T>) {
+				return static_cast<T>(static_cast<std::int64_t>((value >> 1) ^ (0 - (value & 1))));
+			}
+			else {
+				return static_cast<T>(value);
+			}
+		}
+
+		// writes value to out as a varint, returning the number of bytes written (at most 10)
+		inline std::size_t encode_varint(std::uint64_t value, std::byte* out) {
+			std::size_t n = 0;
+			while (value >= 0x80) {
+				out[n++] = std::byte(value | 0x80);
+				value >>= 7;
+			}
+			out[n++] = std::byte(value);
+			return n;
+		}
+
+		inline void write_varint(BinaryWriter& writer, std::uint64_t value) {
+			std::byte bytes[10];
+			writer.write(bytes, encode_varint(value, bytes));
+		}
+
+		inline void write_key(BinaryWriter& writer, std::uint32_t tag, WireType type) {
+			write_varint(writer, std::uint64_t{tag} << 3 | static_cast<std::uint8_t>(type));
+		}
+
+		// Calls write_body, then puts the length of what it wrote in front of it.
+		// One byte is reserved up front, so only bodies of 128 bytes or more
+		// have to be moved to make room.
+		void write_length_prefixed(BinaryWriter& writer, auto&& write_body) {
+			auto start = writer.out.size();
+			writer.put(0);
+			write_body();
+			auto size = writer.out.size() - start - 1;
+			std::byte prefix[10];
+			auto n = encode_varint(size, prefix);
+			writer.out[start] = prefix[0];
+			writer.out.insert(writer.out.begin() + start + 1, prefix + 1, prefix + n);
+		}
+
+		template<typename T>
+		void write_tagged_fields(BinaryWriter& writer, const T& value);
+
+		// the value of one field, without its key
+		template<typename V>
+		void write_tagged_value(BinaryWriter& writer, const V& value) {
+			if constexpr (std::floating_point<V>) {
+				writer.write_scalar(value);
+			}
+			else if constexpr (std::is_arithmetic_v<V>) {
+				write_varint(writer, zigzag(value));
+			}
+			else if constexpr (IsString<V>) {
+				std::string_view s = value;
+				write_varint(writer, s.size());
+				writer.write(s.data(), s.size());
+			}
+			else if constexpr (Reflectable<V>) {
+				write_length_prefixed(writer, [&] {
+					write_tagged_fields(writer, value);
+				});
+			}
+		}
+
+		template<std::uint32_t Tag, typename V>
+		void write_tagged_field(BinaryWriter& writer, const V& value) {
+			if constexpr (TaggedScalar<V>) {
+				write_key(writer, Tag, wire_type<V>());
+				write_tagged_value(writer, value);
+			}
+			else if constexpr (IsOptional<V>) {
+				if (value) {
+					write_tagged_field<Tag>(writer, *value);
+				}
+			}
+			else if constexpr (IsMap<V>) {
+				for (const auto& [key, mapped] : value) {
+					write_key(writer, Tag, WireType::LengthDelimited);
+					write_length_prefixed(writer, [&] {
+						write_tagged_field<1>(writer, key);
+						write_tagged_field<2>(writer, mapped);
+					});
+				}
+			}
+			else if constexpr (std::is_arithmetic_v<std::ranges::range_value_t<V>>) {
+				if (!std::ranges::empty(value)) {
+					write_key(writer, Tag, WireType::LengthDelimited);
+					write_length_prefixed(writer, [&] {
+						for (std::ranges::range_value_t<V> x : value) {
+							write_tagged_value(writer, x);
+						}
+					});
+				}
+			}
+			else {
+				for (const auto& x : value) {
+					write_tagged_field<Tag>(writer, x);
+				}
+			}
+		}
+
+		template<typename T>
+		void write_tagged_fields(BinaryWriter& writer, const T& value) {
+			static_assert(tags_unique<T>, "Two fields of the struct have the same tag");
+			auto visitor = [&](const auto& field) {
+				using field_t = std::remove_cvref_t<decltype(field)>;
+				if constexpr (TaggedValue<typename field_t::type>) {
+					write_tagged_field<field_tag<field_t>()>(writer, field.value);
+				}
+			};
+			kser::visit_fields(value, visitor);
+		}
+
+		inline std::uint64_t read_varint(BinaryReader& reader) {
+			std::uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				auto byte = std::to_integer<std::uint64_t>(*reader.take(1));
+				value |= (byte & 0x7f) << shift;
+				if (!(byte & 0x80)) {
+					return value;
+				}
+			}
+			throw ParseError("Varint is longer than 10 bytes", reader.pos);
+		}
+
+		inline std::size_t read_length(BinaryReader& reader) {
+			auto size = read_varint(reader);
+			if (size > reader.in.size() - reader.pos) {
+				throw ParseError("Unexpected end of input", reader.pos);
+			}
+			return static_cast<std::size_t>(size);
+		}
+
+		inline void expect_wire_type(const BinaryReader& reader, WireType type, WireType expected) {
+			if (type != expected) {
+				throw ParseError("Field has the wrong wire type", reader.pos);
+			}
+		}
+
+		inline void skip_tagged_value(BinaryReader& reader, WireType type) {
+			switch (type) {
+				case WireType::Varint:
+					read_varint(reader);
+					break;
+				case WireType::Fixed64:
+					reader.take(8);
+					break;
+				case WireType::LengthDelimited:
+					reader.take(read_length(reader));
+					break;
+				case WireType::Fixed32:
+					reader.take(4);
+					break;
+				default:
+					throw ParseError("Unknown wire type", reader.pos);
+			}
+		}
+
+		// reads fields until end, calling read_field(tag, wire type) for each,
+		// which returns whether it read the value
+		void read_tagged_keys(BinaryReader& reader, std::size_t end, auto&& read_field) {
+			while (reader.pos < end) {
+				auto key = read_varint(reader);
+				auto type = static_cast<WireType>(key & 7);
+				if (!read_field(key >> 3, type)) {
+					skip_tagged_value(reader, type);
+				}
+			}
+			if (reader.pos > end) {
+				throw ParseError("Field runs past the end of its struct", end);
+			}
+		}
+
+		template<typename T>
+		void read_tagged_fields(BinaryReader& reader, T& value, std::size_t end);
+
+		template<typename V>
+		void read_tagged_value(BinaryReader& reader, V& value) {
+			if constexpr (std::floating_point<V>) {
+				value = reader.read_scalar<V>();
+			}
+			else if constexpr (std::is_arithmetic_v<V>) {
+				value = unzigzag<V>(read_varint(reader));
+			}
+			else if constexpr (IsString<V>) {
+				auto size = read_length(reader);
+				auto data = reader.take(size);
+				value.assign(reinterpret_cast<const char*>(data), size);
+			}
+			else if constexpr (Reflectable<V>) {
+				auto size = read_length(reader);
+				read_tagged_fields(reader, value, reader.pos + size);
+			}
+		}
+
+		// returns false for fields that aren't TaggedValues, so they are skipped
+		template<typename V>
+		bool read_tagged_field(BinaryReader& reader, V& value, WireType type) {
+			if constexpr (TaggedScalar<V>) {
+				expect_wire_type(reader, type, wire_type<V>());
+				read_tagged_value(reader, value);
+				return true;
+			}
+			else if constexpr (IsOptional<V> && TaggedScalar<typename V::value_type>) {
+				return read_tagged_field(reader, value ? *value : value.emplace(), type);
+			}
+			else if constexpr (IsMap<V> && TaggedValue<V>) {
+				expect_wire_type(reader, type, WireType::LengthDelimited);
+				auto size = read_length(reader);
+				typename V::key_type key{};
+				typename V::mapped_type mapped{};
+				read_tagged_keys(reader, reader.pos + size, [&](std::uint64_t tag, WireType entry_type) {
+					return (tag == 1 && read_tagged_field(reader, key, entry_type))
+						|| (tag == 2 && read_tagged_field(reader, mapped, entry_type));
+				});
+				value.insert_or_assign(std::move(key), std::move(mapped));
+				return true;
+			}
+			else if constexpr (TaggedValue<V>) {
+				using element_t = std::ranges::range_value_t<V>;
+				if constexpr (std::is_arithmetic_v<element_t>) {
+					if (type == WireType::LengthDelimited) {
+						auto size = read_length(reader);
+						auto end = reader.pos + size;
+						while (reader.pos < end) {
+							element_t x;
+							read_tagged_value(reader, x);
+							value.push_back(x);
+						}
+						if (reader.pos > end) {
+							throw ParseError("Packed value runs past the end of its field", end);
+						}
+						return true;
+					}
+					// not packed
+					expect_wire_type(reader, type, wire_type<element_t>());
+					element_t x;
+					read_tagged_value(reader, x);
+					value.push_back(x);
+				}
+				else {
+					expect_wire_type(reader, type, WireType::LengthDelimited);
+					read_tagged_value(reader, emplace_back_element(value));
+				}
+				return true;
+			}
+			else {
+				return false;
+			}
+		}
+
+		template<typename T>
+		void read_tagged_fields(BinaryReader& reader, T& value, std::size_t end) {
+			static_assert(tags_unique<T>, "Two fields of the struct have the same tag");
+			std::size_t hint = 0;
+			read_tagged_keys(reader, end, [&](std::uint64_t tag, WireType type) {
+				auto i = find_tag<T>(tag, hint);
+				hint = i + 1;
+				auto start = reader.pos;
+				auto read = visit_field_at(value, i, [&](auto& field) {
+					return read_tagged_field(reader, field.value, type);
+				});
+				if (read) {
+					instrument_field<T>(Operation::DeserializeTagged, i, reader.pos - start);
+				}
+				return read;
+			});
+		}
+	}
+
+	// Appends the tagged form of value to out. Larger than serialize_binary for
+	// the keys, but usually well under half the size of the JSON, and readable
+	// by builds whose struct has gained, lost or reordered fields.
+	template<typename T>
+		requires Reflectable<T>
+	void serialize_tagged(const T& value, std::vector<std::byte>& out) {
+		detail::BinaryWriter writer{out};
+		detail::write_tagged_fields(writer, value);
+	}
+
+	template<typename T>
+		requires Reflectable<T>
+	std::vector<std::byte> serialize_tagged(const T& value) {
+		std::vector<std::byte> out;
+		serialize_tagged(value, out);
+		return out;
+	}
+
+	// Reads all of in into out. Fields out doesn't have are skipped, fields in
+	// doesn't have are left as they are, and sequences and maps are added to.
+	// Throws ParseError if in is malformed or a field has the wrong wire type.
+	template<typename T>
+		requires Reflectable<T>
+	void deserialize_tagged(std::span<const std::byte> in, T& out) {
+		detail::InstrumentScope<T> scope(Operation::DeserializeTagged);
+		scope.add_bytes(in.size());
+		detail::BinaryReader reader{in};
+		detail::read_tagged_fields(reader, out, in.size());
+	}
+
+	template<typename T>
+		requires Reflectable<T> && std::default_initializable<T>
+	T deserialize_tagged(std::span<const std::byte> in) {
+		T out{};
+		deserialize_tagged(in, out);
+		return out;
+	}
+
+	// Reads into a struct from make_with_resource, so its strings allocate from resource.
+	template<typename T>
+		requires Reflectable<T>
+	T deserialize_tagged(std::span<const std::byte> in, std::pmr::memory_resource* resource) {
+		auto out = make_with_resource<T>(resource);
+		deserialize_tagged(in, out);
+		return out;
+	}
+}
\ No newline at end of file
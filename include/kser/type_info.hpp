@@ -0,0 +1,110 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <kser/serialize.hpp>
+#include <any>
+#include <array>
+#include <cstddef> 		// byte
+#include <span>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+
+namespace kser {
+	// A field of a TypeInfo. The function pointers take a pointer to the whole struct.
+	struct FieldInfo {
+		std::string_view name;
+		// of the value, from the start of the struct
+		std::size_t offset;
+		const std::type_info* type;
+
+		// each of these is nullptr if the field's type doesn't support it
+
+		// copies the value out
+		std::any (*get)(const void* s) = nullptr;
+		// throws TypeMismatch unless value holds exactly the field's type
+		void (*set)(void* s, const std::any& value) = nullptr;
+		// appends the value as JSON
+		void (*serialize_json)(const void* s, std::string& out) = nullptr;
+	};
+
+	// Everything needed to work with a Reflectable type known only at runtime,
+	// instantiated once per type rather than at every call site.
+	struct TypeInfo {
+		const std::type_info* type;
+		std::size_t size;
+		std::span<const FieldInfo> fields;
+		// index into fields, or fields.size()
+		std::size_t (*find_index)(std::string_view name);
+		void (*serialize_json)(const void* s, std::string& out);
+
+		const FieldInfo* find(std::string_view name) const {
+			auto i = find_index(name);
+			return i < fields.size() ? &fields[i] : nullptr;
+		}
+	};
+
+	namespace detail {
+		template<typename T, std::size_t I>
+		FieldInfo make_field_info(std::size_t offset) {
+			using value_t = field_value_at_t<T, I>;
+			FieldInfo info{field_names<T>[I], offset, &typeid(value_t)};
+			if constexpr (std::copy_constructible<value_t>) {
+				info.get = [](const void* s) -> std::any {
+					return kser::get<I>(*static_cast<const T*>(s));
+				};
+			}
+			if constexpr (std::is_copy_assignable_v<value_t>) {
+				info.set = [](void* s, const std::any& value) {
+					auto p = std::any_cast<value_t>(&value);
+					if (!p) {
+						throw TypeMismatch(field_names<T>[I]);
+					}
+					kser::get<I>(*static_cast<T*>(s)) = *p;
+				};
+			}
+			if constexpr (JsonSerializable<value_t>) {
+				info.serialize_json = [](const void* s, std::string& out) {
+					kser::serialize_json(kser::get<I>(*static_cast<const T*>(s)), out);
+				};
+			}
+			return info;
+		}
+
+		template<typename T>
+		auto make_field_infos() {
+			return []<std::size_t... I>(std::index_sequence<I...>) {
+				// offsets are measured on a real object, as members can't be
+				// named on storage holding no T
+				const T sample{};
+				auto base = reinterpret_cast<const std::byte*>(&sample);
+				return std::array<FieldInfo, sizeof...(I)>{
+					make_field_info<T, I>(static_cast<std::size_t>(
+						reinterpret_cast<const std::byte*>(&kser::get<I>(sample)) - base
+					))...
+				};
+			}(std::make_index_sequence<field_count<T>>{});
+		}
+	}
+
+	// The descriptor for T, built on first use. Lookups by name use the same
+	// hash table as get_value. Building it value-initializes one T to find the
+	// field offsets, so T must be default constructible.
+	template<typename T>
+		requires Reflectable<T> && std::default_initializable<T>
+	const TypeInfo& type_info() {
+		static const auto fields = detail::make_field_infos<T>();
+		static const TypeInfo info{
+			&typeid(T),
+			sizeof(T),
+			fields,
+			[](std::string_view name) {
+				return detail::name_table<T>.find(name);
+			},
+			[](const void* s, std::string& out) {
+				kser::serialize_json(*static_cast<const T*>(s), out);
+			},
+		};
+		return info;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <kser/kser.hpp>
+#include <kser/binary.hpp>
+#include <array>
+#include <cstring> 		// memcpy
+#include <iterator> 	// default_sentinel_t
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace kser {
+	template<typename T>
+		requires Reflectable<T>
+	class View;
+
+	namespace detail {
+		template<typename V>
+		V load_binary_scalar(const std::byte* p) {
+			V value;
+			std::memcpy(&value, p, sizeof(V));
+			return to_little_endian(value);
+		}
+
+		// size of the binary form of V, if it is the same for every value
+		template<typename V>
+		consteval std::optional<std::size_t> binary_static_size() {
+			if constexpr (std::same_as<V, bool>) {
+				return 1;
+			}
+			else if constexpr (std::is_arithmetic_v<V>) {
+				return sizeof(V);
+			}
+			else if constexpr (Reflectable<V>) {
+				return []<std::size_t... I>(std::index_sequence<I...>) -> std::optional<std::size_t> {
+					std::array<std::optional<std::size_t>, sizeof...(I)> sizes{
+						binary_static_size<field_value_at_t<V, I>>()...
+					};
+					std::size_t out = 0;
+					for (auto size : sizes) {
+						if (!size) {
+							return std::nullopt;
+						}
+						out += *size;
+					}
+					return out;
+				}(std::make_index_sequence<field_members<V>.size()>{});
+			}
+			else if constexpr (BinarySerializable<V>) {
+				return std::nullopt;
+			}
+			else {
+				// not written at all
+				return 0;
+			}
+		}
+
+		// size of the binary form of the V at bytes[pos]
+		template<typename V>
+		std::size_t binary_size(std::span<const std::byte> bytes, std::size_t pos) {
+			auto require = [&](std::size_t size) {
+				if (bytes.size() - pos < size) {
+					throw ParseError("Unexpected end of input", pos);
+				}
+			};
+			if constexpr (constexpr auto size = binary_static_size<V>(); size) {
+				require(*size);
+				return *size;
+			}
+			else if constexpr (IsString<V>) {
+				require(sizeof(std::uint32_t));
+				std::size_t size = sizeof(std::uint32_t)
+					+ load_binary_scalar<std::uint32_t>(bytes.data() + pos);
+				require(size);
+				return size;
+			}
+			else {
+				auto start = pos;
+				[&]<std::size_t... I>(std::index_sequence<I...>) {
+					((pos += binary_size<field_value_at_t<V, I>>(bytes, pos)), ...);
+				}(std::make_index_sequence<field_members<V>.size()>{});
+				return pos - start;
+			}
+		}
+
+		// what a View hands out for a field stored as V
+		template<typename V>
+		struct view_value {
+			using type = V;
+		};
+
+		template<IsString V>
+		struct view_value<V> {
+			using type = std::string_view;
+		};
+
+		template<Reflectable V>
+		struct view_value<V> {
+			using type = View<V>;
+		};
+
+		template<typename V>
+		using view_value_t = typename view_value<V>::type;
+	}
+
+	// A read-only view of a record written by serialize_binary, read in place.
+	// Field offsets are worked out once when the view is made (folding to
+	// constants for fields that only follow fixed-size ones), so reading a
+	// field is a single load. Strings come back as views into the bytes and
+	// nested structs as views of their own, so the bytes must outlive the view.
+	template<typename T>
+		requires Reflectable<T>
+	class View {
+		static constexpr std::size_t field_count = detail::field_members<T>.size();
+
+	public:
+		template<std::size_t I>
+		using stored_t = detail::field_value_at_t<T, I>;
+
+		// Throws ParseError if bytes is shorter than the record.
+		explicit View(std::span<const std::byte> bytes) {
+			std::size_t pos = 0;
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((offsets[I] = pos, pos += detail::binary_size<stored_t<I>>(bytes, pos)), ...);
+			}(std::make_index_sequence<field_count>{});
+			data = bytes.first(pos);
+		}
+
+		// the bytes of this record only
+		std::span<const std::byte> bytes() const {
+			return data;
+		}
+
+		std::size_t size() const {
+			return data.size();
+		}
+
+		template<std::size_t I>
+			requires BinarySerializable<stored_t<I>>
+		detail::view_value_t<stored_t<I>> get() const {
+			using V = stored_t<I>;
+			auto p = data.data() + offsets[I];
+			if constexpr (std::same_as<V, bool>) {
+				return std::to_integer<std::uint8_t>(*p) != 0;
+			}
+			else if constexpr (std::is_arithmetic_v<V>) {
+				return detail::load_binary_scalar<V>(p);
+			}
+			else if constexpr (IsString<V>) {
+				auto size = detail::load_binary_scalar<std::uint32_t>(p);
+				return {reinterpret_cast<const char*>(p + sizeof(std::uint32_t)), size};
+			}
+			else {
+				return View<V>(data.subspan(offsets[I]));
+			}
+		}
+
+		// calls f(name, value) with the I-th field, where I == i;
+		// f returns whether it handled the field
+		bool visit_at(std::size_t i, auto&& f) const {
+			return [&]<std::size_t... I>(std::index_sequence<I...>) {
+				return (... || (I == i && [&] {
+					if constexpr (BinarySerializable<stored_t<I>>) {
+						return static_cast<bool>(f(detail::field_names<T>[I], this->template get<I>()));
+					}
+					else {
+						return false;
+					}
+				}()));
+			}(std::make_index_sequence<field_count>{});
+		}
+
+		// calls f(name, value) with each field, stopping early if f returns true
+		void visit(auto&& f) const {
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				(... || [&] {
+					if constexpr (BinarySerializable<stored_t<I>>) {
+						using result_t = decltype(f(detail::field_names<T>[I], this->template get<I>()));
+						if constexpr (std::convertible_to<result_t, bool>) {
+							return static_cast<bool>(f(detail::field_names<T>[I], this->template get<I>()));
+						}
+						else {
+							f(detail::field_names<T>[I], this->template get<I>());
+						}
+					}
+					return false;
+				}());
+			}(std::make_index_sequence<field_count>{});
+		}
+
+	private:
+		std::span<const std::byte> data;
+		std::array<std::size_t, field_count> offsets{};
+	};
+
+	template<typename T>
+	bool has_field(View<T> view, std::string_view name) {
+		return view.visit_at(detail::name_table<T>.find(name), [](auto&&, auto&&) {
+			return true;
+		});
+	}
+
+	template<typename U, typename T>
+	std::optional<U> try_get_value(View<T> view, std::string_view name) {
+		std::optional<U> out;
+		view.visit_at(detail::name_table<T>.find(name), [&](auto&&, const auto& value) {
+			if constexpr (std::assignable_from<decltype((out)), decltype(value)>) {
+				out = value;
+			}
+			return true;
+		});
+		return out;
+	}
+
+	template<typename U, bool Strict = false, typename T>
+		requires std::default_initializable<U>
+	U get_value(View<T> view, std::string_view name) {
+		U out;
+		auto set = view.visit_at(detail::name_table<T>.find(name), [&](auto&&, const auto& value) -> bool {
+			using value_t = std::remove_cvref_t<decltype(value)>;
+			if constexpr (Strict && std::same_as<U, value_t>) {
+				out = value;
+				return true;
+			}
+			else if constexpr (!Strict && std::assignable_from<decltype((out)), decltype(value)>) {
+				out = value;
+				return true;
+			}
+			else {
+				throw TypeMismatch(name);
+			}
+		});
+		if (!set) {
+			throw FieldNotFound(name);
+		}
+		return out;
+	}
+
+	template<typename U, typename T>
+		requires std::default_initializable<U>
+	U get_value_strict(View<T> view, std::string_view name) {
+		return get_value<U, true>(view, name);
+	}
+
+	template<typename T>
+	void visit_name_values(View<T> view, auto visitor) {
+		view.visit(visitor);
+	}
+
+	template<typename T>
+	void visit_values(View<T> view, auto visitor) {
+		view.visit([&](std::string_view, const auto& value) {
+			return visitor(value);
+		});
+	}
+
+	// Views of records written back to back, such as a file of serialize_binary output.
+	template<typename T>
+	class RecordViews {
+	public:
+		class iterator {
+		public:
+			using value_type = View<T>;
+			using difference_type = std::ptrdiff_t;
+
+			iterator() = default;
+
+			explicit iterator(std::span<const std::byte> bytes) : rest(bytes) {
+				load();
+			}
+
+			const View<T>& operator *() const {
+				return *current;
+			}
+
+			const View<T>* operator ->() const {
+				return &*current;
+			}
+
+			iterator& operator ++() {
+				// an empty record would never advance
+				rest = current->size() ? rest.subspan(current->size()) : std::span<const std::byte>{};
+				load();
+				return *this;
+			}
+
+			void operator ++(int) {
+				++*this;
+			}
+
+			bool operator ==(std::default_sentinel_t) const {
+				return !current;
+			}
+
+		private:
+			void load() {
+				if (rest.empty()) {
+					current.reset();
+				}
+				else {
+					current.emplace(rest);
+				}
+			}
+
+			std::span<const std::byte> rest;
+			std::optional<View<T>> current;
+		};
+
+		explicit RecordViews(std::span<const std::byte> bytes) : bytes(bytes) {}
+
+		iterator begin() const {
+			return iterator{bytes};
+		}
+
+		std::default_sentinel_t end() const {
+			return {};
+		}
+
+	private:
+		std::span<const std::byte> bytes;
+	};
+
+	template<typename T>
+	RecordViews<T> record_views(std::span<const std::byte> bytes) {
+		return RecordViews<T>{bytes};
+	}
+}
\ No newline at end of file
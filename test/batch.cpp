@@ -0,0 +1,47 @@
+#include <kser/batch.hpp>
+#include <ktest/KTest.hpp>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+struct BatchRecord {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::string, "name"> name;
+};
+
+TEST_CASE("Batch serialize", test_batch_serialize) {
+	std::vector<BatchRecord> records;
+	for (int i = 0; i < 1000; ++i) {
+		records.push_back({i, "record " + std::to_string(i)});
+	}
+
+	std::string expected = "[";
+	for (const auto& record : records) {
+		if (expected.size() > 1) {
+			expected += ", ";
+		}
+		kser::serialize_json(record, expected);
+	}
+	expected += "]";
+
+	for (std::size_t threads : {1, 2, 3, 8, 5000}) {
+		test.AssertEq(
+			kser::serialize_json_batch(records, kser::JsonBatchFormat::Array, threads),
+			expected,
+			"Same as serializing in order"
+		);
+	}
+	test.AssertEq(kser::serialize_json_batch(records), expected, "Default thread count");
+
+	std::string out = "prefix";
+	kser::serialize_json_batch(std::vector<BatchRecord>{}, out);
+	test.AssertEq(out, "prefix[]"s, "Appends, and empty ranges give an empty array");
+
+	std::vector<BatchRecord> two{{1, "a"}, {2, "b"}};
+	test.AssertEq(
+		kser::serialize_json_batch(two, kser::JsonBatchFormat::Lines, 2),
+		"{\"id\": 1, \"name\": \"a\"}\n{\"id\": 2, \"name\": \"b\"}\n"s,
+		"One value per line"
+	);
+}
\ No newline at end of file
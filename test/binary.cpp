@@ -0,0 +1,88 @@
+#include <kser/binary.hpp>
+#include <ktest/KTest.hpp>
+#include <memory_resource>
+
+using namespace std::string_literals;
+
+struct BinaryNested {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+};
+
+struct BinaryData {
+	kser::NamedField<float, "x"> x;
+	kser::NamedField<float, "y"> y;
+	kser::NamedField<char, "c"> c;
+	// padding before i, so it starts a new run
+	kser::NamedField<int, "i"> i;
+	int unnamed;
+	kser::NamedField<bool, "flag"> flag;
+	kser::NamedField<BinaryNested, "nested"> nested;
+	kser::NamedField<double, "d"> d;
+};
+
+TEST_CASE("Binary round trip", test_binary_round_trip) {
+	BinaryData data {
+		1.5f,
+		-2.5f,
+		'c',
+		7,
+		99,
+		true,
+		BinaryNested { 3, "nested string" },
+		0.25,
+	};
+
+	auto bytes = kser::serialize_binary(data);
+	// 4 + 4 + 1 + 4 + 1 + (4 + 4 + 13) + 8
+	test.AssertEq(bytes.size(), 43, "Only named fields are written, without padding");
+
+	BinaryData out{};
+	auto read = kser::deserialize_binary(bytes, out);
+	test.AssertEq(read, bytes.size(), "Reads every byte");
+	test.AssertApprox(out.x.value, 1.5f, "Float x");
+	test.AssertApprox(out.y.value, -2.5f, "Float y");
+	test.AssertEq(out.c.value, 'c', "Char");
+	test.AssertEq(out.i.value, 7, "Int");
+	test.AssertEq(out.unnamed, 0, "Unnamed members are not written");
+	test.Assert(out.flag.value, "Bool");
+	test.AssertEq(out.nested.value.a.value, 3, "Nested int");
+	test.AssertEq(out.nested.value.s.value, "nested string"s, "Nested string");
+	test.AssertApprox(out.d.value, 0.25, "Double");
+}
+
+TEST_CASE("Binary layout", test_binary_layout) {
+	auto bytes = kser::serialize_binary(BinaryNested { 0x01020304, "ab" });
+	test.AssertEq(bytes.size(), 10, "Int, length and characters");
+	test.AssertEq(std::to_integer<int>(bytes[0]), 0x04, "Little endian int");
+	test.AssertEq(std::to_integer<int>(bytes[3]), 0x01, "Little endian int");
+	test.AssertEq(std::to_integer<int>(bytes[4]), 0x02, "Little endian length");
+	test.AssertEq(std::to_integer<int>(bytes[8]), 'a', "String characters");
+}
+
+TEST_CASE("Binary truncated input", test_binary_truncated) {
+	auto bytes = kser::serialize_binary(BinaryNested { 1, "hello" });
+	for (std::size_t size = 0; size < bytes.size(); ++size) {
+		bool threw = false;
+		try {
+			kser::deserialize_binary<BinaryNested>(std::span(bytes).first(size));
+		} catch (const kser::ParseError& e) {
+			threw = true;
+		}
+		test.Assert(threw, "Truncated input throws ParseError");
+	}
+}
+
+struct BinaryPmr {
+	kser::NamedField<std::pmr::string, "s"> s;
+	int unnamed = 5;
+};
+
+TEST_CASE("Binary with resource", test_binary_resource) {
+	auto bytes = kser::serialize_binary(BinaryPmr { std::pmr::string("hello"), 0 });
+	std::pmr::monotonic_buffer_resource arena;
+	auto out = kser::deserialize_binary<BinaryPmr>(bytes, &arena);
+	test.Assert(out.s.value == "hello", "String");
+	test.Assert(out.s.value.get_allocator().resource() == &arena, "Strings use the resource");
+	test.AssertEq(out.unnamed, 5, "Unnamed members keep their defaults");
+}
\ No newline at end of file
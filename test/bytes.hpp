@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef> 	// byte
+#include <initializer_list>
+#include <vector>
+
+// expected encodings, written as a list of byte values
+inline std::vector<std::byte> byte_vector(std::initializer_list<int> bytes) {
+	std::vector<std::byte> out;
+	for (auto b : bytes) {
+		out.push_back(std::byte(b));
+	}
+	return out;
+}
\ No newline at end of file
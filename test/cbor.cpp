@@ -0,0 +1,36 @@
+#include "bytes.hpp"
+#include <kser/cbor.hpp>
+#include <ktest/KTest.hpp>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+struct CborData {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+	int unnamed;
+};
+
+TEST_CASE("Serialize cbor", test_serialize_cbor) {
+	test.Assert(
+		kser::serialize_cbor(CborData { 1, "ab", 3 })
+			== byte_vector({0xa2, 0x61, 'a', 0x01, 0x61, 's', 0x62, 'a', 'b'}),
+		"Structs are maps of their named fields"
+	);
+	test.Assert(
+		kser::serialize_cbor(std::vector<std::int64_t>{-1, -25, 24, 500, 1000000})
+			== byte_vector({0x85, 0x20, 0x38, 0x18, 0x18, 0x18, 0x19, 0x01, 0xf4, 0x1a, 0x00, 0x0f, 0x42, 0x40}),
+		"Smallest integer encodings"
+	);
+	test.Assert(
+		kser::serialize_cbor(std::map<int, std::optional<double>>{{1, 1.5}, {2, std::nullopt}})
+			== byte_vector({0xa2, 0x01, 0xfb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0, 0x02, 0xf6}),
+		"Integer keys, doubles and null"
+	);
+	test.Assert(
+		kser::serialize_cbor(std::vector<bool>{true, false}) == byte_vector({0x82, 0xf5, 0xf4}),
+		"Bools"
+	);
+	test.Assert(kser::serialize_cbor(1.5f) == byte_vector({0xfa, 0x3f, 0xc0, 0x00, 0x00}), "Single precision floats");
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <kser/delta.hpp>
+#include <ktest/KTest.hpp>
+
+using namespace std::string_literals;
+
+struct DeltaNested {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+};
+
+struct DeltaData {
+	kser::NamedField<float, "x"> x;
+	kser::NamedField<float, "y"> y;
+	int unnamed;
+	kser::NamedField<bool, "flag"> flag;
+	kser::NamedField<DeltaNested, "nested"> nested;
+	kser::NamedField<double, "d"> d;
+};
+
+TEST_CASE("Delta round trip", test_delta_round_trip) {
+	DeltaData from {
+		1.5f,
+		-2.5f,
+		99,
+		true,
+		DeltaNested { 3, "nested string" },
+		0.25,
+	};
+
+	auto to = from;
+	to.y.value = 4.0f;
+	to.nested.value.s.value = "changed";
+
+	auto delta = kser::diff(from, to);
+	// mask + 4 + (4 + 4 + 7)
+	test.AssertEq(delta.size(), 20, "Only changed fields are written");
+	test.AssertEq(std::to_integer<int>(delta[0]), 0b1010, "Changed fields are marked in the mask");
+
+	auto out = from;
+	auto read = kser::apply_delta(delta, out);
+	test.AssertEq(read, delta.size(), "Reads the whole delta");
+	test.AssertApprox(out.x.value, 1.5f, "Unchanged fields are kept");
+	test.AssertApprox(out.y.value, 4.0f, "Changed fields are applied");
+	test.AssertEq(out.nested.value.s.value, "changed"s, "Changed nested fields are applied");
+	test.AssertEq(out.nested.value.a.value, 3, "Nested fields are applied whole");
+
+	std::vector<std::byte> same;
+	test.Assert(!kser::diff(from, from, same), "Equal values have no changes");
+	test.AssertEq(same.size(), 1, "Just the mask");
+
+	bool threw = false;
+	try {
+		kser::apply_delta(std::span(delta).first(3), out);
+	} catch (const kser::ParseError&) {
+		threw = true;
+	}
+	test.Assert(threw, "Short input throws ParseError");
+}
\ No newline at end of file
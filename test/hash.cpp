@@ -0,0 +1,111 @@
+#include <kser/hash.hpp>
+#include <ktest/KTest.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+enum class HashKind : std::uint8_t {
+	A,
+	B,
+};
+
+struct HashVec {
+	kser::NamedField<int, "x"> x;
+	kser::NamedField<int, "y"> y;
+};
+
+struct HashData {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::uint32_t, "b"> b;
+	kser::NamedField<HashKind, "kind"> kind;
+	int unnamed;
+	kser::NamedField<double, "d"> d;
+	kser::NamedField<std::string, "s"> s;
+	kser::NamedField<HashVec, "vec"> vec;
+	kser::NamedField<std::vector<int>, "ints"> ints;
+	kser::NamedField<std::vector<HashVec>, "vecs"> vecs;
+	kser::NamedField<std::optional<std::string>, "opt"> opt;
+	kser::NamedField<std::map<std::string, HashVec>, "map"> map;
+	kser::NamedField<std::unordered_set<int>, "set"> set;
+};
+
+HashData make_hash_data() {
+	return HashData {
+		1,
+		2,
+		HashKind::B,
+		3,
+		0.0,
+		"a string long enough to be hashed in more than one block of words",
+		HashVec { 4, 5 },
+		std::vector<int> { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 },
+		std::vector<HashVec> { HashVec { 6, 7 } },
+		"optional",
+		std::map<std::string, HashVec> { { "key", HashVec { 8, 9 } } },
+		std::unordered_set<int> { 1, 2, 3 },
+	};
+}
+
+TEST_CASE("Hash and equal", test_hash_equal) {
+	auto a = make_hash_data();
+	auto b = make_hash_data();
+	test.Assert(kser::equal(a, b), "Copies are equal");
+	test.AssertEq(kser::hash(a), kser::hash(b), "Copies hash the same");
+
+	b.unnamed = 99;
+	b.d.value = -0.0;
+	b.set.value = std::unordered_set<int> { 3, 2, 1 };
+	b.set.value.rehash(64);
+	test.Assert(kser::equal(a, b), "Members that aren't NamedFields, zero signs and set order are ignored");
+	test.AssertEq(kser::hash(a), kser::hash(b), "Equal values hash the same");
+
+	auto differs = [&](auto&& change) {
+		auto c = make_hash_data();
+		change(c);
+		return !kser::equal(a, c) && !kser::equal(c, a) && kser::hash(a) != kser::hash(c);
+	};
+	test.Assert(differs([](HashData& c) { c.b.value = 0; }), "Fields in a run of integers are compared");
+	test.Assert(differs([](HashData& c) { c.kind.value = HashKind::A; }), "Enums are compared");
+	test.Assert(differs([](HashData& c) { c.d.value = 0.5; }), "Floats are compared");
+	test.Assert(differs([](HashData& c) { c.s.value.back() = '!'; }), "Strings are compared");
+	test.Assert(differs([](HashData& c) { c.vec.value.y.value = 0; }), "Nested structs are compared");
+	test.Assert(differs([](HashData& c) { c.ints.value.pop_back(); }), "Sequence sizes are compared");
+	test.Assert(differs([](HashData& c) { c.vecs.value[0].x.value = 0; }), "Structs in sequences are compared");
+	test.Assert(differs([](HashData& c) { c.opt.value.reset(); }), "Empty optionals are compared");
+	test.Assert(differs([](HashData& c) { c.map.value["key"].x.value = 0; }), "Map values are compared");
+	test.Assert(differs([](HashData& c) { c.set.value.insert(4); }), "Sets are compared");
+
+	std::unordered_map<HashVec, int, kser::Hash, kser::Equal> map;
+	map[HashVec { 1, 2 }] = 3;
+	test.Assert(map.contains(HashVec { 1, 2 }), "Reflected structs work as keys");
+	test.Assert(!map.contains(HashVec { 2, 1 }), "Keys differing in a field are distinct");
+}
+
+struct HashMulti {
+	kser::NamedField<std::unordered_multiset<int>, "set"> set;
+	kser::NamedField<std::unordered_multimap<std::string, int>, "map"> map;
+};
+
+TEST_CASE("Hash and equal multisets", test_hash_equal_multi) {
+	HashMulti a {
+		std::unordered_multiset<int> { 1, 1, 2 },
+		std::unordered_multimap<std::string, int> { { "k", 1 }, { "k", 2 }, { "j", 3 } },
+	};
+	auto b = a;
+	b.set.value = std::unordered_multiset<int> { 2, 1, 1 };
+	b.map.value = std::unordered_multimap<std::string, int> { { "j", 3 }, { "k", 2 }, { "k", 1 } };
+	test.Assert(kser::equal(a, b), "Equal whatever order duplicates are in");
+	test.AssertEq(kser::hash(a), kser::hash(b), "Equal multisets hash the same");
+
+	auto c = a;
+	c.set.value = std::unordered_multiset<int> { 1, 2, 2 };
+	test.Assert(!kser::equal(a, c) && !kser::equal(c, a), "Multiset counts are compared");
+
+	auto d = a;
+	d.map.value = std::unordered_multimap<std::string, int> { { "k", 2 }, { "k", 2 }, { "j", 3 } };
+	test.Assert(!kser::equal(a, d) && !kser::equal(d, a), "Every value of a repeated key is compared");
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <kser/binary.hpp>
+#include <kser/parse.hpp>
+#include <kser/serialize.hpp>
+#include <kser/stream.hpp>
+#include <kser/tagged.hpp>
+#include <ktest/KTest.hpp>
+#include <algorithm>
+#include <any>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace instrumented {
+	struct Record {
+		kser::NamedField<int, "id"> id;
+		kser::NamedField<std::string, "name"> name;
+	};
+}
+
+static const kser::TypeStats* find_stats(const std::vector<kser::TypeStats>& stats, std::string_view name) {
+	auto it = std::ranges::find(stats, name, &kser::TypeStats::name);
+	return it == stats.end() ? nullptr : &*it;
+}
+
+TEST_CASE("Type names", test_type_names) {
+	test.Assert(kser::detail::type_name<instrumented::Record>() == "instrumented::Record", "Struct names");
+	test.Assert(kser::detail::type_name<int>() == "int", "Builtin names");
+}
+
+TEST_CASE("Instrumentation", test_instrumentation) {
+	instrumented::Record record { 7, "abc" };
+	kser::reset_instrumentation();
+	auto json = kser::serialize_json(record);
+	kser::serialize_json(record);
+	std::ostringstream os;
+	kser::serialize_json(record, os);
+	auto tagged = kser::serialize_tagged(record);
+	kser::deserialize_tagged<instrumented::Record>(tagged);
+	auto binary = kser::serialize_binary(record);
+	kser::deserialize_binary<instrumented::Record>(binary);
+	instrumented::Record streamed{};
+	kser::JsonStreamParser<instrumented::Record> stream{streamed};
+	stream.feed(json);
+	kser::parse_json<instrumented::Record>(R"({"name": "x", "unknown": 1})");
+	kser::set_values(record, std::map<std::string_view, std::any>{{"id", 1}});
+	kser::get_value_map<std::map<std::string_view, std::any>>(record);
+	auto stats = kser::instrumentation_snapshot();
+	auto found = find_stats(stats, "instrumented::Record");
+
+	if constexpr (kser::instrumentation_enabled) {
+		test.Assert(found != nullptr, "Used types are listed");
+		if (found) {
+			test.AssertEq((*found)[kser::Operation::SerializeJson].calls, 3, "Serialize calls");
+			test.AssertEq((*found)[kser::Operation::SerializeJson].bytes, 3 * json.size(), "Serialized bytes, streams included");
+			test.AssertEq((*found)[kser::Operation::ParseJson].calls, 1, "Parse calls");
+			test.AssertEq((*found)[kser::Operation::SetValues].calls, 1, "Set values calls");
+			test.AssertEq((*found)[kser::Operation::GetValueMap].calls, 1, "Get value map calls");
+			test.AssertEq(found->fields.size(), 2, "Fields");
+			test.Assert(found->fields[1].name == "name", "Field names");
+			// "abc" with its quotes, three times
+			test.AssertEq(found->fields[1].bytes[std::to_underlying(kser::Operation::SerializeJson)], 15, "Field bytes");
+			test.AssertEq(found->fields[0].calls[std::to_underlying(kser::Operation::ParseJson)], 0, "Missing fields aren't counted");
+			test.AssertEq(found->fields[1].calls[std::to_underlying(kser::Operation::ParseJson)], 1, "Parsed fields");
+			test.AssertEq(found->fields[0].calls[std::to_underlying(kser::Operation::SetValues)], 1, "Set fields");
+
+			test.AssertEq((*found)[kser::Operation::DeserializeTagged].calls, 1, "Deserialize tagged calls");
+			test.AssertEq((*found)[kser::Operation::DeserializeTagged].bytes, tagged.size(), "Deserialized tagged bytes");
+			// a length byte and "abc"
+			test.AssertEq(found->fields[1].bytes[std::to_underlying(kser::Operation::DeserializeTagged)], 4, "Tagged field bytes");
+			test.AssertEq((*found)[kser::Operation::DeserializeBinary].calls, 1, "Deserialize binary calls");
+			test.AssertEq((*found)[kser::Operation::DeserializeBinary].bytes, binary.size(), "Deserialized binary bytes");
+			test.AssertEq((*found)[kser::Operation::ParseJsonStream].calls, 1, "Stream parser feeds");
+			test.AssertEq((*found)[kser::Operation::ParseJsonStream].bytes, json.size(), "Streamed bytes");
+
+			std::uint64_t timed = 0;
+			for (auto n : (*found)[kser::Operation::SerializeJson].latency) {
+				timed += n;
+			}
+			test.AssertEq(timed, 3, "Every call is in the latency histogram");
+		}
+	}
+	else {
+		test.Assert(stats.empty(), "Nothing is recorded unless KSER_INSTRUMENT is defined");
+	}
+}
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <any>
 #include <variant>
 #include <map>
+#include <memory_resource>
+#include <span>
+#include <vector>
 
 using namespace std::string_literals;
 
@@ -87,6 +90,161 @@ TEST_CASE("Try get fields", test_try_get_field) {
 	test.AssertEq(s.a.value, 3, "Field value changed");
 }
 
+TEST_CASE("Name lookup", test_name_lookup) {
+	struct Wide {
+		kser::NamedField<int, "a"> a{0};
+		kser::NamedField<int, "b"> b{1};
+		kser::NamedField<int, "ab"> ab{2};
+		kser::NamedField<int, "ba"> ba{3};
+		int unnamed{-1};
+		kser::NamedField<int, "max_health"> max_health{4};
+		kser::NamedField<int, "max_mana"> max_mana{5};
+		kser::NamedField<int, "position_x"> position_x{6};
+		kser::NamedField<int, "position_y"> position_y{7};
+		kser::NamedField<int, "position_z"> position_z{8};
+		kser::NamedField<int, "velocity_x"> velocity_x{9};
+		kser::NamedField<int, "velocity_y"> velocity_y{10};
+		kser::NamedField<int, "velocity_z"> velocity_z{11};
+		kser::NamedField<std::string, "name"> name{"wide"};
+	};
+
+	Wide w;
+	const char* names[] = {
+		"a", "b", "ab", "ba",
+		"max_health", "max_mana",
+		"position_x", "position_y", "position_z",
+		"velocity_x", "velocity_y", "velocity_z",
+	};
+
+	for (int i = 0; i < std::ssize(names); ++i) {
+		test.Assert(kser::has_field(w, names[i]), "Has every named field");
+		test.AssertEq(kser::get_value<int>(w, names[i]), i, "Name resolves to the right field");
+	}
+
+	test.Assert(!kser::has_field(w, "unnamed"), "Unnamed members are not found");
+	test.Assert(!kser::has_field(w, ""), "Empty name is not found");
+	test.Assert(!kser::has_field(w, "position_w"), "Similar name is not found");
+	test.Assert(!kser::try_get_value<int>(w, "name").has_value(), "Wrong type is not returned");
+
+	test.Assert(kser::set_value(w, "velocity_y", 42), "Set value by name");
+	test.AssertEq(w.velocity_y.value, 42, "Only the named field changes");
+	test.AssertEq(w.velocity_x.value, 9, "Neighbouring field unchanged");
+
+	const Wide& cw = w;
+	test.AssertEq(kser::get_value<std::string>(cw, "name"), "wide"s, "Lookup through const reference");
+}
+
+// a requires-expression outside a template can't check invalid expressions
+template<typename T, kser::StaticString Name>
+concept HasFieldIndex = requires { kser::field_index<T, Name>; };
+
+TEST_CASE("Compile time metadata", test_compile_time_metadata) {
+	struct Meta {
+		kser::NamedField<int, "id"> id{1};
+		int unnamed{-1};
+		kser::NamedField<std::string, "name"> name{"meta"};
+		kser::NamedField<float, "weight"> weight{0.5f};
+	};
+
+	static_assert(kser::field_count<Meta> == 3);
+	static_assert(kser::field_index<Meta, "id"> == 0);
+	static_assert(kser::field_index<Meta, "weight"> == 2);
+	static_assert(std::same_as<kser::field_type_t<Meta, 1>, std::string>);
+	static_assert(kser::field_name<Meta, 2> == "weight");
+	static_assert(!HasFieldIndex<Meta, "unnamed">);
+
+	Meta m;
+	kser::get<kser::field_index<Meta, "weight">>(m) = 2.0f;
+	test.AssertApprox(m.weight.value, 2.0f, "Get by index is assignable");
+	test.AssertEq(kser::get<0>(m), 1, "Get by index");
+
+	const Meta& cm = m;
+	static_assert(std::same_as<decltype(kser::get<1>(cm)), const std::string&>);
+	test.AssertEq(kser::get<1>(cm), "meta"s, "Get by index through const reference");
+}
+
+template<typename T, kser::StaticString Name>
+concept HasCompileTimeValue = requires(T& s) { kser::get_value<Name>(s); };
+
+TEST_CASE("Compile time names", test_compile_time_names) {
+	S s;
+
+	test.AssertEq(kser::get_value<"a">(s), 1, "Get value");
+	test.AssertEq(kser::get_value<"b">(s), "hello"s, "Get string value");
+
+	kser::set_value<"a">(s, 5);
+	test.AssertEq(s.a.value, 5, "Set value");
+
+	auto& field = kser::get_field<"b">(s);
+	field.value = "world";
+	test.AssertEq(s.b.value, "world"s, "Field reference");
+	static_assert(std::same_as<decltype(kser::get_field<"b">(s)), kser::NamedField<std::string, "b">&>);
+
+	test.Assert(kser::has_field<"a">(s), "Has field");
+	test.Assert(!kser::has_field<"c">(s), "Missing field");
+	static_assert(HasCompileTimeValue<S, "a">);
+	static_assert(!HasCompileTimeValue<S, "c">, "Unknown names don't satisfy the constraints");
+
+	const S& cs = s;
+	test.AssertEq(kser::get_value<"a">(cs), 5, "Through const reference");
+}
+
+struct PathVec {
+	kser::NamedField<float, "x"> x;
+	kser::NamedField<float, "y"> y;
+};
+
+struct PathPhysics {
+	kser::NamedField<PathVec, "velocity"> velocity;
+	kser::NamedField<float, "mass"> mass;
+};
+
+struct PathBody {
+	kser::NamedField<PathPhysics, "physics"> physics;
+	kser::NamedField<std::string, "name"> name;
+};
+
+template<typename T, kser::StaticString Path>
+concept HasValuePath = requires(T& s) { kser::get_value_path<Path>(s); };
+
+TEST_CASE("Field paths", test_field_paths) {
+	PathBody body{};
+
+	kser::set_value_path<"physics.velocity.x">(body, 3.0f);
+	test.AssertApprox(body.physics.value.velocity.value.x.value, 3.0f, "Set compile time path");
+	test.AssertApprox(kser::get_value_path<"physics.velocity.x">(body), 3.0f, "Get compile time path");
+	static_assert(std::same_as<decltype(kser::get_value_path<"physics.velocity">(body)), PathVec&>);
+	static_assert(!HasValuePath<PathBody, "physics.speed">, "Unknown paths don't compile");
+	static_assert(!HasValuePath<PathBody, "name.x">, "Paths only go through structs");
+
+	const PathBody& cbody = body;
+	static_assert(std::same_as<decltype(kser::get_value_path<"physics.mass">(cbody)), const float&>);
+
+	test.AssertApprox(kser::get_value_path<float>(body, "physics.velocity.x"), 3.0f, "Get runtime path");
+	test.Assert(kser::set_value_path(body, "physics.velocity.y", 4.0f), "Set runtime path");
+	test.AssertApprox(body.physics.value.velocity.value.y.value, 4.0f, "Runtime path value set");
+	test.Assert(!kser::set_value_path(body, "physics.nope", 1.0f), "Unknown runtime path");
+	test.Assert(!kser::set_value_path(body, "name.x", 1.0f), "Runtime path through a non-struct");
+	test.Assert(!kser::try_get_value_path<float>(body, "physics.velocity.z"), "Try get unknown path");
+	test.AssertApprox(*kser::try_get_value_path<float>(cbody, "physics.mass"), 0.0f, "Try get through const reference");
+
+	bool threw = false;
+	try {
+		kser::get_value_path<float>(body, "physics.velocity.q");
+	} catch (const kser::FieldNotFound&) {
+		threw = true;
+	}
+	test.Assert(threw, "Get unknown path throws");
+
+	threw = false;
+	try {
+		kser::set_value_path(body, "name", 1.5f);
+	} catch (const kser::TypeMismatch&) {
+		threw = true;
+	}
+	test.Assert(threw, "Set wrong type throws");
+}
+
 TEST_CASE("Get field value", test_get_field_value) {
 	S s;
 	auto a = kser::get_value<std::optional<int>>(s, "a");
@@ -124,6 +282,61 @@ TEST_CASE("Get value strict mode", test_get_value_strict) {
 	} catch (const kser::TypeMismatch& e) {}
 }
 
+TEST_CASE("Expected accessors", test_expected_accessors) {
+	S s;
+
+	auto a = kser::get_value_expected<int>(s, "a");
+	test.Assert(a.has_value(), "Found value");
+	test.AssertEq(*a, 1, "Right value");
+
+	auto missing = kser::get_value_expected<int>(s, "missing");
+	test.Assert(!missing && missing.error().code == kser::ErrorCode::FieldNotFound, "Missing field");
+	test.Assert(missing.error().name == "missing", "Error names the field");
+
+	auto mismatch = kser::get_value_expected<int>(s, "b");
+	test.Assert(!mismatch && mismatch.error().code == kser::ErrorCode::TypeMismatch, "Type mismatch");
+	test.Assert(!kser::get_value_strict_expected<float>(s, "a"), "Strict type mismatch");
+
+	auto field = kser::get_field_with_name_expected<std::string>(s, "b");
+	test.Assert(field && field->get().value == "hello", "Field reference");
+	test.Assert(
+		kser::get_field_with_name_expected<int>(s, "b").error().code == kser::ErrorCode::TypeMismatch,
+		"Field of another type"
+	);
+
+	test.Assert(kser::set_value_expected(s, "a", 5).has_value(), "Set value");
+	test.AssertEq(s.a.value, 5, "Value set");
+	test.Assert(
+		kser::set_value_expected(s, "b", 1.5).error().code == kser::ErrorCode::TypeMismatch,
+		"Set value of the wrong type"
+	);
+
+	auto in = std::map<std::string_view, std::any>{
+		{"a", 7},
+		{"b", 3},
+		{"c", 1},
+	};
+	std::vector<kser::Error> errors;
+	auto set = kser::set_values_expected(s, in, [&](const kser::Error& error) {
+		errors.push_back(error);
+	});
+	test.Assert(!set, "Set values reports failures");
+	test.AssertEq(errors.size(), 2, "Every failed key is reported");
+	test.Assert(errors[0].code == kser::ErrorCode::TypeMismatch && errors[0].name == "b", "Wrong type key");
+	test.Assert(errors[1].code == kser::ErrorCode::FieldNotFound && errors[1].name == "c", "Unknown key");
+	test.AssertEq(s.a.value, 7, "Other keys are still set");
+
+	using variant = std::variant<std::monostate, int, std::string>;
+	auto variants = std::map<std::string_view, variant>{
+		{"a", 9},
+		{"b", "x"s},
+	};
+	set = kser::set_values_expected(s, variants);
+	test.Assert(set.has_value(), "Set values from variants");
+	test.AssertEq(*set, 2, "Set count");
+	test.AssertEq(s.b.value, "x"s, "Variant value set");
+}
+
 TEST_CASE("Field and value maps", test_field_and_value_maps) {
 	S s {
 		10,
@@ -138,6 +351,25 @@ TEST_CASE("Field and value maps", test_field_and_value_maps) {
 
 	test.AssertEq(map["b"].index(), 2, "Map has string");
 	test.AssertEq(std::get<std::string>(map["b"]), "hello", "Map has right string value");
+
+	auto static_map = kser::get_value_map<kser::StaticValueMap<S, variant>>(s);
+	test.AssertEq(static_map.size(), 2, "Static map has every field");
+	test.AssertEq(std::get<int>(static_map["a"]), 10, "Static map has right int value");
+	test.AssertEq(std::get<std::string>(static_map.at("b")), "hello", "Static map has right string value");
+	test.Assert(static_map.begin()->first == "a", "Static map is in field order");
+	test.Assert(!static_map.contains("c"), "Static map only has fields");
+
+	bool threw = false;
+	try {
+		static_map["c"];
+	} catch (const kser::FieldNotFound&) {
+		threw = true;
+	}
+	test.Assert(threw, "Static map throws for names that aren't fields");
+
+	s.a.value = 11;
+	kser::get_value_map(s, static_map);
+	test.AssertEq(std::get<int>(static_map["a"]), 11, "Static map refilled in place");
 }
 
 TEST_CASE("Setting values", test_set_values) {
@@ -209,6 +441,31 @@ TEST_CASE("Setting values", test_set_values) {
 	test.AssertEq(num_set, 2, "Set all values for number map");
 	test.AssertEq(n.x.value, 30, "Field x set");
 	test.AssertEq(n.y.value, 40, "Field y set");
+
+	auto partial_map = std::map<std::string_view, int>{
+		{"y", 50},
+	};
+	num_set = kser::set_values(n, partial_map);
+	test.AssertEq(num_set, 1, "Set values from a smaller map");
+	test.AssertEq(n.x.value, 30, "Field x unchanged");
+	test.AssertEq(n.y.value, 50, "Field y set from smaller map");
+
+	std::pair<std::string_view, int> pairs[] = {
+		{"x", 1},
+		{"z", 2},
+		{"y", 3},
+	};
+	num_set = kser::set_values(n, std::span(pairs));
+	test.AssertEq(num_set, 2, "Set values from a span of pairs");
+	test.AssertEq(n.x.value, 1, "Field x set from pairs");
+	test.AssertEq(n.y.value, 3, "Field y set from pairs");
+
+	auto string_key_map = std::map<std::string, std::any>{
+		{"b", "from string keys"s},
+	};
+	num_set = kser::set_values(s, string_key_map);
+	test.AssertEq(num_set, 1, "Set values from a map with std::string keys");
+	test.AssertEq(s.b.value, "from string keys", "Field b set from std::string key");
 }
 
 TEST_CASE("Visitor", test_visitor) {
@@ -294,4 +551,67 @@ TEST_CASE("Visitor", test_visitor) {
 	kser::visit_values(s, value_visitor_shorting);
 	test.Assert(visited_a, "Visitor visited field a (shorting)");
 	test.Assert(!visited_b, "Visitor did not visit field b (shorting)");
+}
+
+struct PmrNested {
+	kser::NamedField<std::pmr::string, "s"> s;
+};
+
+struct PmrRecord {
+	kser::NamedField<std::pmr::string, "name"> name;
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::pmr::vector<int>, "values"> values;
+	kser::NamedField<PmrNested, "nested"> nested;
+	std::pmr::string unnamed;
+};
+
+TEST_CASE("Make with resource", test_make_with_resource) {
+	std::pmr::monotonic_buffer_resource arena;
+	auto r = kser::make_with_resource<PmrRecord>(&arena);
+	test.Assert(r.name.value.get_allocator().resource() == &arena, "Strings use the resource");
+	test.Assert(r.values.value.get_allocator().resource() == &arena, "Containers use the resource");
+	test.Assert(r.nested.value.s.value.get_allocator().resource() == &arena, "Nested structs use the resource");
+	test.Assert(r.unnamed.get_allocator().resource() == &arena, "Unnamed members use the resource");
+
+	// anything allocated outside the arena would throw
+	auto previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+	std::string long_string(100, 'x');
+	std::string other_string(100, 'y');
+	std::map<std::string_view, std::string> in{{"s", long_string}};
+	// assigned as is, not converted to a std::pmr::string on the default resource first
+	static_assert(std::same_as<
+		kser::Caster<std::pmr::string, std::string, kser::DefaultCaster>,
+		kser::AssignCaster<std::pmr::string>
+	>);
+	bool threw = false;
+	bool set_from_map = false;
+	try {
+		kser::set_values(r.nested.value, in);
+		set_from_map = std::string_view(r.nested.value.s.value) == long_string;
+		kser::set_value(r.nested.value, "s", std::string_view(other_string));
+	} catch (const std::bad_alloc&) {
+		threw = true;
+	}
+	std::pmr::set_default_resource(previous);
+	test.Assert(!threw, "Setting strings allocates from the resource");
+	test.Assert(set_from_map, "Set values from std::strings");
+	test.Assert(std::string_view(r.nested.value.s.value) == other_string, "Set value");
+}
+
+struct PmrDefaults {
+	kser::NamedField<int, "id"> id{7};
+	kser::NamedField<std::pmr::string, "name"> name{std::pmr::string(100, 'd')};
+	kser::NamedField<PmrNested, "nested"> nested{PmrNested { std::pmr::string("nested default") }};
+	int unnamed = 3;
+};
+
+TEST_CASE("Make with resource keeps defaults", test_make_with_resource_defaults) {
+	std::pmr::monotonic_buffer_resource arena;
+	auto r = kser::make_with_resource<PmrDefaults>(&arena);
+	test.AssertEq(r.id.value, 7, "Ints keep their defaults");
+	test.Assert(std::string_view(r.name.value) == std::string(100, 'd'), "Strings keep their defaults");
+	test.Assert(r.name.value.get_allocator().resource() == &arena, "Strings with defaults use the resource");
+	test.Assert(std::string_view(r.nested.value.s.value) == "nested default", "Nested structs keep their defaults");
+	test.Assert(r.nested.value.s.value.get_allocator().resource() == &arena, "Nested strings with defaults use the resource");
+	test.AssertEq(r.unnamed, 3, "Unnamed members keep their defaults");
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "bytes.hpp"
+#include <kser/msgpack.hpp>
+#include <ktest/KTest.hpp>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+struct MsgPackData {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+	int unnamed;
+};
+
+TEST_CASE("Serialize msgpack", test_serialize_msgpack) {
+	test.Assert(
+		kser::serialize_msgpack(MsgPackData { 1, "ab", 3 })
+			== byte_vector({0x82, 0xa1, 'a', 0x01, 0xa1, 's', 0xa2, 'a', 'b'}),
+		"Structs are maps of their named fields"
+	);
+	test.Assert(
+		kser::serialize_msgpack(std::vector<std::int64_t>{-1, -33, 200, 70000})
+			== byte_vector({0x94, 0xff, 0xd0, 0xdf, 0xcc, 0xc8, 0xce, 0x00, 0x01, 0x11, 0x70}),
+		"Smallest integer encodings"
+	);
+	test.Assert(
+		kser::serialize_msgpack(std::map<int, std::optional<double>>{{1, 1.5}, {2, std::nullopt}})
+			== byte_vector({0x82, 0x01, 0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0, 0x02, 0xc0}),
+		"Integer keys, doubles and nil"
+	);
+	test.Assert(
+		kser::serialize_msgpack(std::vector<bool>{true, false}) == byte_vector({0x92, 0xc3, 0xc2}),
+		"Bools"
+	);
+
+	std::vector<std::byte> out;
+	kser::serialize_msgpack(std::string(40, 'x'), out);
+	test.AssertEq(out.size(), 42, "str8 header");
+	test.AssertEq(std::to_integer<int>(out[0]), 0xd9, "str8 tag");
+}
\ No newline at end of file
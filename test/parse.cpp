@@ -0,0 +1,240 @@
+#include <kser/parse.hpp>
+#include <kser/serialize.hpp>
+#include <ktest/KTest.hpp>
+#include <array>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+using namespace std::string_literals;
+
+struct ParseNested {
+	kser::NamedField<int, "a"> a;
+};
+
+struct ParseData {
+	kser::NamedField<int, "int_val"> int_val;
+	kser::NamedField<float, "float_val"> float_val;
+	kser::NamedField<bool, "bool_val"> bool_val;
+	kser::NamedField<std::string, "string_val"> string_val;
+	kser::NamedField<ParseNested, "nested"> nested_val;
+	int unnamed;
+};
+
+TEST_CASE("Parse json", test_parse_json) {
+	auto d = kser::parse_json<ParseData>(
+		R"({"int_val": 10, "float_val": 2.5, "bool_val": true, "string_val": "hi", "nested": {"a": 20}})"
+	);
+
+	test.AssertEq(d.int_val.value, 10, "Integers");
+	test.AssertApprox(d.float_val.value, 2.5f, "Floats");
+	test.Assert(d.bool_val.value, "Bools");
+	test.AssertEq(d.string_val.value, "hi"s, "Strings");
+	test.AssertEq(d.nested_val.value.a.value, 20, "Nested structs");
+
+	test.AssertEq(kser::parse_json<int>(" -3 "), -3, "Top level scalars");
+	test.AssertEq(kser::parse_json<std::string>(R"("a\"b\\c\né")"), "a\"b\\c\n\xc3\xa9"s, "Escapes");
+}
+
+TEST_CASE("Parse json skips unknown keys", test_parse_json_unknown) {
+	ParseData d{};
+	d.int_val.value = 5;
+	kser::parse_json(
+		R"(  {
+			"unknown": [1, {"x": "}"}, null, false],
+			"unnamed": 3,
+			"string_val": "a string long enough to be scanned sixteen bytes at a time",
+			"int_val": null
+		}  )",
+		d
+	);
+
+	test.AssertEq(d.int_val.value, 5, "Null leaves the field untouched");
+	test.AssertEq(d.unnamed, 0, "Unnamed members are not parsed");
+	test.AssertEq(
+		d.string_val.value,
+		"a string long enough to be scanned sixteen bytes at a time"s,
+		"Long strings"
+	);
+
+	auto nested = [](std::size_t depth) {
+		return R"({"unknown": )" + std::string(depth, '[') + std::string(depth, ']') + "}";
+	};
+	kser::parse_json<ParseData>(nested(100));
+	bool threw = false;
+	try {
+		kser::parse_json<ParseData>(nested(300000));
+	} catch (const kser::ParseError&) {
+		threw = true;
+	}
+	test.Assert(threw, "Deeply nested unknown values throw instead of overflowing the stack");
+}
+
+TEST_CASE("Parse json round trip", test_parse_json_round_trip) {
+	ParseData d{};
+	d.int_val.value = -7;
+	d.float_val.value = 1.25f;
+	d.string_val.value = "quote \" and tab \t";
+	d.nested_val.value.a.value = 3;
+
+	auto parsed = kser::parse_json<ParseData>(kser::serialize_json(d));
+	test.AssertEq(parsed.int_val.value, -7, "Int round trips");
+	test.AssertApprox(parsed.float_val.value, 1.25f, "Float round trips");
+	test.AssertEq(parsed.string_val.value, d.string_val.value, "String round trips");
+	test.AssertEq(parsed.nested_val.value.a.value, 3, "Nested round trips");
+}
+
+TEST_CASE("Parse json errors", test_parse_json_errors) {
+	const char* bad[] = {
+		"",
+		"{",
+		R"({"int_val" 1})",
+		R"({"int_val": 1,})",
+		R"({"int_val": "x"})",
+		R"({"string_val": "unterminated)",
+		R"({} trailing)",
+	};
+
+	for (auto json : bad) {
+		bool threw = false;
+		try {
+			kser::parse_json<ParseData>(json);
+		} catch (const kser::ParseError& e) {
+			threw = true;
+		}
+		test.Assert(threw, "Malformed json throws ParseError");
+	}
+}
+
+TEST_CASE("Parse json containers", test_parse_json_containers) {
+	struct Containers {
+		kser::NamedField<std::vector<float>, "floats"> floats;
+		kser::NamedField<std::vector<std::string>, "strings"> strings;
+		kser::NamedField<std::array<int, 3>, "ints"> ints;
+		kser::NamedField<std::optional<ParseNested>, "maybe"> maybe;
+		kser::NamedField<std::map<std::string, int>, "by_name"> by_name;
+		kser::NamedField<std::map<int, bool>, "by_id"> by_id;
+	};
+
+	Containers c{};
+	c.floats.value = {9.0f};
+	kser::parse_json(
+		R"({
+			"floats": [1.5, -2, 3e1],
+			"strings": ["a", "b\"c"],
+			"ints": [4, 5],
+			"maybe": {"a": 6},
+			"by_name": {"x": 1, "y": 2},
+			"by_id": {"-3": true}
+		})",
+		c
+	);
+
+	test.Assert(c.floats.value == std::vector<float>{1.5f, -2.0f, 30.0f}, "Sequences are replaced");
+	test.Assert(c.strings.value == std::vector<std::string>{"a", "b\"c"}, "Sequences of strings");
+	test.Assert(c.ints.value == std::array<int, 3>{4, 5, 0}, "Fixed size arrays");
+	test.Assert(c.maybe.value && c.maybe.value->a.value == 6, "Optionals");
+	test.Assert(c.by_name.value == std::map<std::string, int>{{"x", 1}, {"y", 2}}, "String keys");
+	test.Assert(c.by_id.value == std::map<int, bool>{{-3, true}}, "Integer keys");
+
+	kser::parse_json(R"({"maybe": null})", c);
+	test.Assert(!c.maybe.value, "Null empties optionals");
+
+	auto round_trip = kser::parse_json<Containers>(kser::serialize_json(c));
+	test.Assert(round_trip.floats.value == c.floats.value, "Round trip sequences");
+	test.Assert(round_trip.by_name.value == c.by_name.value, "Round trip maps");
+
+	bool threw = false;
+	try {
+		kser::parse_json<std::array<int, 2>>("[1, 2, 3]");
+	} catch (const kser::ParseError&) {
+		threw = true;
+	}
+	test.Assert(threw, "Too many elements for a fixed size array");
+}
+
+struct ParsePmrNested {
+	kser::NamedField<std::pmr::string, "s"> s;
+};
+
+struct ParsePmr {
+	kser::NamedField<std::pmr::string, "name"> name;
+	kser::NamedField<std::pmr::vector<std::pmr::string>, "tags"> tags;
+	kser::NamedField<std::pmr::vector<ParsePmrNested>, "list"> list;
+	kser::NamedField<std::pmr::map<std::pmr::string, int>, "counts"> counts;
+};
+
+TEST_CASE("Parse json with resource", test_parse_json_resource) {
+	// long enough not to fit in a string's own buffer
+	std::string long_string(100, 'x');
+	auto json = R"({"name": ")" + long_string + R"(", "tags": [")" + long_string
+		+ R"("], "list": [{"s": ")" + long_string + R"("}], "counts": {")" + long_string + R"(": 1}})";
+
+	std::pmr::monotonic_buffer_resource arena;
+	// anything allocated outside the arena would throw
+	auto previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+	std::optional<ParsePmr> d;
+	bool threw = false;
+	try {
+		d.emplace(kser::parse_json<ParsePmr>(json, &arena));
+	} catch (const std::bad_alloc&) {
+		threw = true;
+	}
+	std::pmr::set_default_resource(previous);
+
+	test.Assert(!threw && d, "Parsing allocates from the resource");
+	if (!d) {
+		return;
+	}
+	test.Assert(d->name.value.get_allocator().resource() == &arena, "Strings");
+	test.Assert(d->tags.value[0].get_allocator().resource() == &arena, "Strings in containers");
+	test.Assert(d->list.value[0].s.value.get_allocator().resource() == &arena, "Structs in containers");
+	test.Assert(d->counts.value.begin()->first.get_allocator().resource() == &arena, "Map keys");
+	test.Assert(std::string_view(d->list.value[0].s.value) == long_string, "Values");
+}
+
+struct ParseDefaults {
+	kser::NamedField<int, "id"> id{7};
+	kser::NamedField<std::pmr::string, "name"> name{std::pmr::string("default")};
+};
+
+struct ParseDefaultsList {
+	kser::NamedField<std::pmr::vector<ParseDefaults>, "list"> list;
+};
+
+TEST_CASE("Parse json with resource keeps defaults", test_parse_json_resource_defaults) {
+	std::pmr::monotonic_buffer_resource arena;
+	auto d = kser::parse_json<ParseDefaults>(R"({"name": "set"})", &arena);
+	test.AssertEq(d.id.value, 7, "Missing fields keep their defaults");
+	test.Assert(d.name.value == "set", "Present fields are read");
+	test.Assert(d.name.value.get_allocator().resource() == &arena, "Strings use the resource");
+
+	auto list = kser::parse_json<ParseDefaultsList>(R"({"list": [{"name": "set"}, {"id": 1}]})");
+	test.AssertEq(list.list.value.size(), 2, "Structs in pmr vectors");
+	test.AssertEq(list.list.value[0].id.value, 7, "Structs in pmr vectors keep defaults");
+	test.Assert(list.list.value[1].name.value == "default", "Structs in pmr vectors keep string defaults");
+
+	auto in_arena = kser::parse_json<ParseDefaultsList>(R"({"list": [{"name": "set"}]})", &arena);
+	test.AssertEq(in_arena.list.value[0].id.value, 7, "Structs in pmr vectors keep defaults with a resource");
+	test.Assert(
+		in_arena.list.value[0].name.value.get_allocator().resource() == &arena,
+		"Structs in pmr vectors use the resource"
+	);
+}
+
+struct ParseView {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::string_view, "label"> label;
+};
+
+TEST_CASE("Parse json skips string views", test_parse_json_string_view) {
+	auto json = kser::serialize_json(ParseView { 3, "written" });
+	ParseView out { 0, "kept" };
+	kser::parse_json(json, out);
+	test.AssertEq(out.id.value, 3, "Reads what serialize_json writes");
+	test.Assert(out.label.value == "kept", "Views are left as they are");
+
+	kser::parse_json(R"({"label": ["not", "a", "string"], "id": 4})", out);
+	test.AssertEq(out.id.value, 4, "Other values given to views are skipped too");
+}
\ No newline at end of file
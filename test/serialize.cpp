@@ -1,4 +1,10 @@
+#include <array>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <kser/serialize.hpp>
 #include <ktest/KTest.hpp>
 
@@ -26,4 +32,152 @@ TEST_CASE("Serialize json", test_serialize_json){
 
 	test.AssertEq(kser::serialize_json(Nested { 10 }), "{\"a\": 10}", "Struct");
 	test.AssertEq(kser::serialize_json(d), "{\"int_val\": 10, \"nested\": {\"a\": 20}}", "Nested");
+}
+
+TEST_CASE("Serialize json into buffers", test_serialize_json_buffers){
+	Data d {
+		10,
+		Nested {
+			20,
+		},
+	};
+
+	std::string out;
+	test.Assert(kser::serialize_json(d, out), "Struct is serializable");
+	test.AssertEq(out, "{\"int_val\": 10, \"nested\": {\"a\": 20}}", "Appends to string");
+
+	kser::serialize_json(true, out);
+	test.AssertEq(out, "{\"int_val\": 10, \"nested\": {\"a\": 20}}true", "Appends after existing content");
+
+	char buf[64];
+	auto end = kser::serialize_json_to(buf, Nested { -5 });
+	test.AssertEq(std::string(buf, end), "{\"a\": -5}", "Writes through output iterator");
+
+	std::stringstream ss;
+	kser::serialize_json(Nested { 7 }, ss);
+	test.AssertEq(ss.str(), "{\"a\": 7}", "Writes to stream");
+
+	test.AssertEq(kser::serialize_json<3>(0.5), "0.500", "Precision");
+	test.AssertEq(kser::serialize_json(false), "false", "Bool");
+	test.AssertEq(
+		kser::serialize_json(std::string("a\"b\\c\n\x01")),
+		"\"a\\\"b\\\\c\\n\\u0001\"",
+		"Strings are escaped"
+	);
+}
+
+TEST_CASE("Serialize json keys", test_serialize_json_keys){
+	struct Opaque {
+		Opaque() {}
+	};
+
+	struct Partial {
+		kser::NamedField<Opaque, "opaque"> opaque;
+		kser::NamedField<int, "x"> x;
+		int unnamed;
+		kser::NamedField<Opaque, "opaque_2"> opaque_2;
+		kser::NamedField<bool, "quoted \"key\""> y;
+	};
+
+	struct Empty {};
+
+	Partial p{};
+	p.x.value = 1;
+	test.AssertEq(
+		kser::serialize_json(p),
+		"{\"x\": 1, \"quoted \\\"key\\\"\": false}",
+		"Unserializable fields are skipped and keys are escaped"
+	);
+	test.AssertEq(kser::serialize_json(Empty{}), "{}", "Struct without fields");
+}
+
+TEST_CASE("Serialize json containers", test_serialize_json_containers){
+	struct Containers {
+		kser::NamedField<std::vector<int>, "ints"> ints;
+		kser::NamedField<std::array<bool, 2>, "bools"> bools;
+		kser::NamedField<std::optional<int>, "maybe"> maybe;
+		kser::NamedField<std::map<std::string, Nested>, "by_name"> by_name;
+		kser::NamedField<std::map<int, std::string>, "by_id"> by_id;
+	};
+
+	Containers c{};
+	c.ints.value = {1, 2, 3};
+	c.bools.value = {true, false};
+	c.by_name.value = {{"x", Nested{1}}};
+	c.by_id.value = {{2, "two"}};
+	test.AssertEq(
+		kser::serialize_json(c),
+		"{\"ints\": [1, 2, 3], \"bools\": [true, false], \"maybe\": null, "
+		"\"by_name\": {\"x\": {\"a\": 1}}, \"by_id\": {\"2\": \"two\"}}",
+		"Containers"
+	);
+
+	c.maybe.value = 4;
+	test.AssertEq(kser::serialize_json(c.maybe.value), "4", "Engaged optional");
+	test.AssertEq(kser::serialize_json(std::vector<int>{}), "[]", "Empty sequence");
+	test.AssertEq(kser::serialize_json(std::vector<std::string>{"a", "b"}), "[\"a\", \"b\"]", "Strings");
+
+	// more numbers than fit in one formatting chunk
+	std::vector<float> floats(3000, 0.5f);
+	auto json = kser::serialize_json(floats);
+	test.AssertEq(json.size(), std::size_t{2 + 3000 * 4 + 2999 * 2}, "Long numeric arrays");
+	test.Assert(json.starts_with("[0.50, 0.50") && json.ends_with("0.50, 0.50]"), "Long numeric array contents");
+}
+
+// writes a compact made up format, to check the traversal
+struct OutlineWriter {
+	std::string out;
+
+	void null() {
+		out += "~";
+	}
+
+	void boolean(bool value) {
+		out += value ? "T" : "F";
+	}
+
+	void number(auto value) {
+		out += std::to_string(value);
+	}
+
+	void string(std::string_view s) {
+		out += s;
+	}
+
+	void begin_array(std::size_t n) {
+		out += "[" + std::to_string(n) + ":";
+	}
+
+	void end_array() {
+		out += "]";
+	}
+
+	void begin_object(std::size_t n) {
+		out += "{" + std::to_string(n) + ":";
+	}
+
+	void key(std::string_view key) {
+		out += key;
+		out += "=";
+	}
+
+	void end_object() {
+		out += "}";
+	}
+};
+
+TEST_CASE("Serialize with a writer", test_serialize_writer){
+	static_assert(kser::Writer<OutlineWriter>);
+
+	OutlineWriter writer;
+	test.Assert(kser::serialize(writer, Data { 1, Nested { 2 } }), "Serializable");
+	test.AssertEq(writer.out, "{2:int_val=1nested={1:a=2}}", "Structs");
+
+	writer.out.clear();
+	kser::serialize(writer, std::map<int, std::vector<bool>>{{3, {true, false}}});
+	test.AssertEq(writer.out, "{1:3=[2:TF]}", "Integer keys as strings, and arrays");
+
+	writer.out.clear();
+	kser::serialize(writer, std::optional<int>{});
+	test.AssertEq(writer.out, "~", "Null");
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <kser/soa.hpp>
+#include <ktest/KTest.hpp>
+
+struct Particle {
+	kser::NamedField<float, "x"> x;
+	kser::NamedField<float, "velocity"> velocity;
+	kser::NamedField<bool, "alive"> alive;
+};
+
+TEST_CASE("SoA vector", test_soa_vector) {
+	kser::SoaVector<Particle> particles;
+	particles.push_back({{1.0f}, {0.5f}, {true}});
+	particles.push_back({{2.0f}, {-1.0f}, {false}});
+	test.AssertEq(particles.size(), 2, "Size");
+
+	auto& x = particles.column<"x">();
+	auto& velocity = particles.column<1>();
+	for (std::size_t i = 0; i < particles.size(); ++i) {
+		x[i] += velocity[i];
+	}
+	test.AssertApprox(x[0], 1.5f, "Update a column by name");
+	test.AssertApprox(x[1], 1.0f, "Update a column by index");
+	test.Assert(particles.column<"alive">()[0], "Bool column");
+
+	auto second = particles[1];
+	test.AssertApprox(kser::get_value<float>(second, "velocity"), -1.0f, "Get through a proxy");
+	kser::set_value(second, "x", 5.0f);
+	kser::get_value<"alive">(second) = true;
+	test.AssertApprox(x[1], 5.0f, "Set through a proxy writes the column");
+	test.Assert(particles.column<"alive">()[1], "Set a bool through a proxy");
+
+	int visited = 0;
+	auto visitor = [&](auto&) {
+		++visited;
+	};
+	kser::visit_fields(second, visitor);
+	test.AssertEq(visited, 3, "Visit the fields of a proxy");
+
+	auto copy = static_cast<Particle>(particles[1]);
+	test.AssertApprox(copy.x.value, 5.0f, "Copy an element out");
+
+	const auto& view = particles;
+	auto first = view[0];
+	test.AssertApprox(kser::get<1>(first), 0.5f, "Const proxy");
+
+	std::size_t size = 0;
+	test.Assert(particles.visit_column("velocity", [&](auto& column) {
+		size = column.size();
+	}), "Visit a column by runtime name");
+	test.AssertEq(size, 2, "Visited column");
+	test.Assert(!particles.visit_column("mass", [](auto&) {}), "Visit an unknown column");
+
+	particles.pop_back();
+	test.AssertEq(particles.size(), 1, "Pop back");
+	particles.clear();
+	test.Assert(particles.empty(), "Clear");
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include <kser/stream.hpp>
+#include <ktest/KTest.hpp>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+struct StreamNested {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+};
+
+struct StreamData {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::string, "name"> name;
+	kser::NamedField<std::vector<int>, "values"> values;
+	kser::NamedField<std::vector<bool>, "flags"> flags;
+	kser::NamedField<std::set<std::string>, "tags"> tags;
+	kser::NamedField<std::map<std::string, int>, "counts"> counts;
+	kser::NamedField<std::optional<StreamNested>, "optional"> optional;
+	kser::NamedField<std::vector<StreamNested>, "list"> list;
+	kser::NamedField<double, "d"> d;
+};
+
+TEST_CASE("Stream parse in chunks", test_stream_chunks) {
+	const std::string json = R"({"id": 42, "name": "a \"quoted\" é name", "skipped": {"x": [1, {"y": "}"}, null]},)"
+		R"( "values": [1, -2, 30000], "flags": [true, false], "tags": ["x", "y"], "counts": {"k": 3},)"
+		R"( "optional": {"a": 7, "s": "o"}, "list": [{"a": 1}, {"a": 2, "s": "two"}], "d": -1.25e2})";
+	auto expected = kser::parse_json<StreamData>(json);
+
+	bool all_match = true;
+	// every chunk size splits some token in every possible place
+	for (std::size_t step = 1; step <= json.size(); ++step) {
+		StreamData out{};
+		kser::JsonStreamParser<StreamData> parser{out};
+		for (std::size_t i = 0; i < json.size(); i += step) {
+			parser.feed(std::string_view(json).substr(i, step));
+		}
+		all_match = all_match
+			&& parser.done()
+			&& out.id.value == expected.id.value
+			&& out.name.value == expected.name.value
+			&& out.values.value == expected.values.value
+			&& out.flags.value == expected.flags.value
+			&& out.tags.value == expected.tags.value
+			&& out.counts.value == expected.counts.value
+			&& out.optional.value->s.value == "o"
+			&& out.list.value.size() == 2
+			&& out.list.value[1].s.value == "two"
+			&& out.d.value == expected.d.value;
+	}
+	test.Assert(all_match, "Same result as parse_json for every chunk size");
+	test.AssertEq(expected.name.value, "a \"quoted\" \xc3\xa9 name"s, "Escapes");
+
+	int n = 0;
+	kser::JsonStreamParser<int> number{n};
+	number.feed("12");
+	number.feed("3");
+	test.Assert(!number.done(), "A number at the end of a chunk may continue");
+	number.finish();
+	test.AssertEq(n, 123, "Finish completes a number");
+}
+
+TEST_CASE("Stream parse messages", test_stream_messages) {
+	std::string_view input = R"({"id": 1} {"id": 2}{"id")";
+	StreamData out{};
+	kser::JsonStreamParser<StreamData> parser{out};
+
+	input.remove_prefix(parser.feed(input));
+	test.Assert(parser.done(), "First message done");
+	test.AssertEq(out.id.value, 1, "First message");
+
+	parser.reset();
+	input.remove_prefix(parser.feed(input));
+	test.Assert(parser.done(), "Second message done");
+	test.AssertEq(out.id.value, 2, "Second message");
+
+	parser.reset();
+	input.remove_prefix(parser.feed(input));
+	test.Assert(!parser.done() && input.empty(), "Third message waits for more input");
+}
+
+TEST_CASE("Stream parse errors", test_stream_errors) {
+	auto error_offset = [](std::string_view json) -> std::size_t {
+		try {
+			StreamData out{};
+			kser::JsonStreamParser<StreamData> parser{out};
+			for (std::size_t i = 0; i < json.size(); ++i) {
+				parser.feed(json.substr(i, 1));
+			}
+			parser.finish();
+		} catch (const kser::ParseError& e) {
+			return e.offset;
+		}
+		return 0;
+	};
+
+	test.AssertEq(error_offset(R"({"id": 1,})"), 9, "Trailing comma");
+	test.AssertEq(error_offset(R"({"id" 1})"), 6, "Missing colon");
+	test.AssertEq(error_offset(R"({"id": "x"})"), 7, "Wrong type");
+	test.AssertEq(error_offset(R"({"skipped": nope})"), 12, "Bad literal in a skipped value");
+	test.AssertEq(error_offset(R"({"id": 1)"), 8, "Unexpected end of input");
+}
+
+struct StreamView {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::string_view, "label"> label;
+};
+
+TEST_CASE("Stream parse skips string views", test_stream_string_view) {
+	StreamView out { 0, "kept" };
+	kser::JsonStreamParser<StreamView> parser{out};
+	parser.feed(R"({"label": "written", "id": 3})");
+	test.Assert(parser.done(), "Done");
+	test.AssertEq(out.id.value, 3, "Other fields are read");
+	test.Assert(out.label.value == "kept", "Views are left as they are");
+}
+
+#ifdef __cpp_lib_generator
+TEST_CASE("Stream parse generator", test_stream_generator) {
+	const std::string lines = "{\"a\": 1, \"s\": \"one\"}\n{\"a\": 2}\n{\"a\": 3, \"s\": \"three\"}\n";
+	std::size_t at = 0;
+	// 5 characters at a time, so records and tokens are split between chunks
+	auto read = [&] {
+		auto chunk = std::string_view(lines).substr(at, 5);
+		at += chunk.size();
+		return chunk;
+	};
+
+	std::vector<int> as;
+	std::vector<std::string> ss;
+	for (auto& record : kser::parse_json_stream<StreamNested>(read)) {
+		as.push_back(record.a.value);
+		ss.push_back(record.s.value);
+	}
+	test.Assert(as == std::vector<int>{1, 2, 3}, "Yields every record in order");
+	test.Assert(ss == std::vector<std::string>{"one", "", "three"}, "Each record starts from a default value");
+
+	// the last number only ends at the end of the input
+	const std::string numbers = "1 22 333";
+	at = 0;
+	auto read_numbers = [&] {
+		auto chunk = std::string_view(numbers).substr(at, 2);
+		at += chunk.size();
+		return chunk;
+	};
+	std::vector<int> ns;
+	for (int n : kser::parse_json_stream<int>(read_numbers)) {
+		ns.push_back(n);
+	}
+	test.Assert(ns == std::vector<int>{1, 22, 333}, "Finishes the last value at the end of the input");
+}
+#endif
\ No newline at end of file
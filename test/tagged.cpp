@@ -0,0 +1,140 @@
+#include "bytes.hpp"
+#include <kser/serialize.hpp>
+#include <kser/tagged.hpp>
+#include <ktest/KTest.hpp>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+using namespace std::string_literals;
+
+struct TaggedPoint {
+	kser::TaggedField<int, "a", 1> a;
+	kser::TaggedField<std::string, "b", 2> b;
+};
+
+struct TaggedInner {
+	kser::NamedField<int, "x"> x;
+	kser::NamedField<std::string, "s"> s;
+};
+
+// an old build's view of TaggedRecord
+struct TaggedRecordV1 {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::string, "name"> name;
+};
+
+struct TaggedRecord {
+	kser::NamedField<double, "score"> score;
+	kser::NamedField<std::string, "name"> name;
+	kser::NamedField<TaggedInner, "inner"> inner;
+	kser::NamedField<std::vector<int>, "list"> list;
+	kser::NamedField<std::vector<TaggedInner>, "inners"> inners;
+	kser::NamedField<std::map<std::string, float>, "map"> map;
+	kser::NamedField<std::optional<long long>, "opt"> opt;
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<bool, "flag"> flag;
+};
+
+// TaggedRecordV1 with a field added since
+struct TaggedDefaults {
+	kser::NamedField<int, "id"> id;
+	kser::NamedField<std::pmr::string, "name"> name;
+	kser::NamedField<int, "level"> level{10};
+};
+
+TEST_CASE("Tagged layout", test_tagged_layout) {
+	test.Assert(
+		kser::serialize_tagged(TaggedPoint { 150, "testing" })
+			== byte_vector({0x08, 0xac, 0x02, 0x12, 0x07, 't', 'e', 's', 't', 'i', 'n', 'g'}),
+		"Keys, zigzag varints and length-prefixed strings"
+	);
+	test.Assert(
+		kser::serialize_tagged(TaggedPoint { -1, "" }) == byte_vector({0x08, 0x01, 0x12, 0x00}),
+		"Small negative numbers are one byte"
+	);
+}
+
+TEST_CASE("Tagged round trip", test_tagged_round_trip) {
+	TaggedRecord record {
+		2.5,
+		"bob",
+		TaggedInner { -7, std::string(200, 'z') },
+		std::vector<int>{1, -2, 300},
+		std::vector<TaggedInner>{{1, "p"}, {2, "q"}},
+		std::map<std::string, float>{{"k", 1.5f}, {"j", 2.0f}},
+		5000000000LL,
+		42,
+		true,
+	};
+	auto bytes = kser::serialize_tagged(record);
+	test.Assert(bytes.size() < kser::serialize_json(record).size(), "Smaller than the JSON");
+
+	auto out = kser::deserialize_tagged<TaggedRecord>(bytes);
+	test.AssertApprox(out.score.value, 2.5, "Double");
+	test.AssertEq(out.name.value, "bob"s, "String");
+	test.AssertEq(out.inner.value.x.value, -7, "Nested int");
+	test.AssertEq(out.inner.value.s.value.size(), 200, "Nested struct longer than 127 bytes");
+	test.Assert(out.list.value == std::vector<int>{1, -2, 300}, "Packed ints");
+	test.AssertEq(out.inners.value.size(), 2, "Repeated structs");
+	test.AssertEq(out.inners.value[1].s.value, "q"s, "Repeated struct contents");
+	test.AssertEq(out.map.value.size(), 2, "Map entries");
+	test.AssertApprox(out.map.value["k"], 1.5f, "Map values");
+	test.Assert(out.opt.value == 5000000000LL, "Optional");
+	test.AssertEq(out.id.value, 42, "Int");
+	test.Assert(out.flag.value, "Bool");
+}
+
+TEST_CASE("Tagged schema evolution", test_tagged_schema_evolution) {
+	TaggedRecord record{};
+	record.score.value = 1.0;
+	record.name.value = "new";
+	record.inner.value.s.value = "skipped";
+	record.list.value = {1, 2, 3};
+	record.map.value["k"] = 1.0f;
+	record.id.value = 7;
+
+	auto old = kser::deserialize_tagged<TaggedRecordV1>(kser::serialize_tagged(record));
+	test.AssertEq(old.id.value, 7, "Old readers skip new fields");
+	test.AssertEq(old.name.value, "new"s, "Old readers keep known fields");
+
+	auto upgraded = kser::deserialize_tagged<TaggedRecord>(
+		kser::serialize_tagged(TaggedRecordV1 { 3, "old" })
+	);
+	test.AssertEq(upgraded.id.value, 3, "New readers read old records");
+	test.Assert(!upgraded.opt.value && upgraded.list.value.empty(), "Missing fields keep their defaults");
+}
+
+TEST_CASE("Tagged errors", test_tagged_errors) {
+	auto bytes = kser::serialize_tagged(TaggedPoint { 1, "abc" });
+	bytes.pop_back();
+	bool threw = false;
+	try {
+		kser::deserialize_tagged<TaggedPoint>(bytes);
+	} catch (const kser::ParseError&) {
+		threw = true;
+	}
+	test.Assert(threw, "Truncated input");
+
+	threw = false;
+	try {
+		// tag 1 as a fixed32
+		kser::deserialize_tagged<TaggedPoint>(byte_vector({0x0d, 0, 0, 0, 0}));
+	} catch (const kser::ParseError&) {
+		threw = true;
+	}
+	test.Assert(threw, "Wrong wire type");
+}
+
+TEST_CASE("Tagged with resource", test_tagged_resource) {
+	std::pmr::monotonic_buffer_resource arena;
+	auto out = kser::deserialize_tagged<TaggedDefaults>(
+		kser::serialize_tagged(TaggedRecordV1 { 3, "old" }),
+		&arena
+	);
+	test.AssertEq(out.id.value, 3, "Int");
+	test.Assert(out.name.value == "old", "String");
+	test.Assert(out.name.value.get_allocator().resource() == &arena, "Strings use the resource");
+	test.AssertEq(out.level.value, 10, "Missing fields keep their defaults");
+}
\ No newline at end of file
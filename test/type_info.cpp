@@ -0,0 +1,75 @@
+#include <kser/type_info.hpp>
+#include <ktest/KTest.hpp>
+#include <memory>
+
+using namespace std::string_literals;
+
+struct InfoNested {
+	kser::NamedField<int, "a"> a;
+};
+
+struct InfoData {
+	kser::NamedField<int, "id"> id;
+	int unnamed;
+	kser::NamedField<std::string, "name"> name;
+	kser::NamedField<InfoNested, "nested"> nested;
+	kser::NamedField<std::unique_ptr<int>, "owned"> owned;
+};
+
+struct InfoNoDefault {
+	InfoNoDefault(int) {}
+};
+
+struct InfoNoDefaultData {
+	kser::NamedField<InfoNoDefault, "value"> value;
+};
+
+template<typename T>
+concept HasTypeInfo = requires { kser::type_info<T>(); };
+
+static_assert(HasTypeInfo<InfoData>);
+// offsets are measured on a default constructed value
+static_assert(!HasTypeInfo<InfoNoDefaultData>);
+
+TEST_CASE("Type info", test_type_info) {
+	const kser::TypeInfo& info = kser::type_info<InfoData>();
+	test.Assert(&info == &kser::type_info<InfoData>(), "One descriptor per type");
+	test.Assert(*info.type == typeid(InfoData), "Type id");
+	test.AssertEq(info.size, sizeof(InfoData), "Size");
+	test.AssertEq(info.fields.size(), 4, "Only named fields are described");
+
+	InfoData d{};
+	d.id.value = 1;
+	d.name.value = "info";
+	d.nested.value.a.value = 2;
+
+	auto name = info.find("name");
+	test.Assert(name != nullptr, "Find by name");
+	test.Assert(name->name == "name", "Field name");
+	test.AssertEq(
+		name->offset,
+		static_cast<std::size_t>(reinterpret_cast<char*>(&d.name.value) - reinterpret_cast<char*>(&d)),
+		"Field offset"
+	);
+	test.Assert(*name->type == typeid(std::string), "Field type id");
+	test.AssertEq(std::any_cast<std::string>(name->get(&d)), "info"s, "Get through descriptor");
+
+	name->set(&d, std::any("renamed"s));
+	test.AssertEq(d.name.value, "renamed"s, "Set through descriptor");
+
+	bool threw = false;
+	try {
+		name->set(&d, std::any(1));
+	} catch (const kser::TypeMismatch&) {
+		threw = true;
+	}
+	test.Assert(threw, "Set with the wrong type throws TypeMismatch");
+
+	std::string json;
+	info.find("nested")->serialize_json(&d, json);
+	test.AssertEq(json, "{\"a\": 2}"s, "Serialize a field through descriptor");
+
+	auto owned = info.find("owned");
+	test.Assert(!owned->get && !owned->set && !owned->serialize_json, "Unsupported operations are null");
+	test.Assert(info.find("unnamed") == nullptr, "Unnamed members are not found");
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <kser/view.hpp>
+#include <ktest/KTest.hpp>
+
+using namespace std::string_literals;
+
+struct ViewNested {
+	kser::NamedField<int, "a"> a;
+	kser::NamedField<std::string, "s"> s;
+};
+
+struct ViewData {
+	kser::NamedField<float, "x"> x;
+	kser::NamedField<std::string, "name"> name;
+	kser::NamedField<ViewNested, "nested"> nested;
+	kser::NamedField<bool, "flag"> flag;
+	kser::NamedField<int, "count"> count;
+};
+
+TEST_CASE("View fields", test_view_fields) {
+	ViewData data {
+		1.5f,
+		"record",
+		ViewNested { 3, "inner" },
+		true,
+		42,
+	};
+	auto bytes = kser::serialize_binary(data);
+	kser::View<ViewData> view(bytes);
+
+	test.AssertEq(view.size(), bytes.size(), "View covers the whole record");
+	test.AssertApprox(view.get<0>(), 1.5f, "Index access");
+	test.AssertEq(view.get<1>(), std::string_view("record"), "Strings are views");
+	test.Assert(
+		view.get<1>().data() == reinterpret_cast<const char*>(bytes.data()) + 8,
+		"Strings point into the bytes"
+	);
+
+	test.AssertEq(kser::get_value<int>(view, "count"), 42, "Name access");
+	test.AssertApprox(kser::get_value<double>(view, "x"), 1.5, "Converting access");
+	test.Assert(kser::get_value<bool>(view, "flag"), "Bool access");
+	test.AssertEq(
+		kser::get_value<std::string_view>(view.get<2>(), "s"),
+		std::string_view("inner"),
+		"Nested views"
+	);
+
+	test.Assert(kser::has_field(view, "name"), "Has field");
+	test.Assert(!kser::has_field(view, "missing"), "Doesn't have missing field");
+	test.Assert(!kser::try_get_value<std::string>(view, "count").has_value(), "Try with wrong type");
+
+	bool threw = false;
+	try {
+		kser::get_value_strict<float>(view, "count");
+	} catch (const kser::TypeMismatch& e) {
+		threw = true;
+	}
+	test.Assert(threw, "Strict access checks the type");
+
+	int visited = 0;
+	kser::visit_name_values(view, [&](std::string_view name, const auto& value) {
+		++visited;
+	});
+	test.AssertEq(visited, 5, "Visits every field");
+}
+
+TEST_CASE("Record views", test_record_views) {
+	std::vector<std::byte> bytes;
+	for (int i = 0; i < 3; ++i) {
+		kser::serialize_binary(ViewNested { i, std::string(i, 'x') }, bytes);
+	}
+
+	int i = 0;
+	for (const auto& view : kser::record_views<ViewNested>(bytes)) {
+		test.AssertEq(kser::get_value<int>(view, "a"), i, "Records in order");
+		test.AssertEq(kser::get_value<std::string>(view, "s"), std::string(i, 'x'), "Variable length records");
+		++i;
+	}
+	test.AssertEq(i, 3, "Every record visited");
+
+	bool threw = false;
+	try {
+		kser::View<ViewNested> view(std::span(bytes).first(6));
+	} catch (const kser::ParseError& e) {
+		threw = true;
+	}
+	test.Assert(threw, "Short records throw ParseError");
+}
\ No newline at end of file